@@ -2,15 +2,21 @@
 #include <debug.h>
 #include "devices/intq.h"
 #include "devices/serial.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
 
 /* Stores keys from the keyboard and serial port. */
 static struct intq buffer;
 
+/* Threads polling for input. */
+static struct wait_queue waiters;
+
 /* Initializes the input buffer. */
 void
 input_init (void) 
 {
   intq_init (&buffer);
+  wait_queue_init (&waiters);
 }
 
 /* Adds a key to the input buffer.
@@ -23,6 +29,7 @@ input_putc (uint8_t key)
 
   intq_putc (&buffer, key);
   serial_notify ();
+  wait_queue_wake (&waiters);
 }
 
 /* Retrieves a key from the input buffer.
@@ -41,6 +48,25 @@ input_getc (void)
   return key;
 }
 
+/* Returns true if a key is waiting in the input buffer, so that
+   input_getc() would not wait.  If E is nonnull, it is also added
+   to the queue of threads that SEMA wakes up when a key
+   arrives. */
+bool
+input_poll (struct wait_entry *e, struct semaphore *sema)
+{
+  enum intr_level old_level;
+  bool ready;
+
+  old_level = intr_disable ();
+  if (e != NULL)
+    wait_queue_add (&waiters, e, sema);
+  ready = !intq_empty (&buffer);
+  intr_set_level (old_level);
+
+  return ready;
+}
+
 /* Returns true if the input buffer is full,
    false otherwise.
    Interrupts must be off. */
@@ -4,9 +4,13 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+struct semaphore;
+struct wait_entry;
+
 void input_init (void);
 void input_putc (uint8_t);
 uint8_t input_getc (void);
 bool input_full (void);
+bool input_poll (struct wait_entry *, struct semaphore *);
 
 #endif /* devices/input.h */
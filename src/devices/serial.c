@@ -129,6 +129,44 @@ serial_putc (uint8_t byte)
   intr_set_level (old_level);
 }
 
+/* Sends the N bytes in BUFFER to the serial port.  Equivalent
+   to calling serial_putc() for each byte, but interrupts are
+   disabled only once and the interrupt enable register is
+   updated only when the transmit queue fills up and at the
+   end. */
+void
+serial_putbuf (const uint8_t *buffer, size_t n) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  if (mode != QUEUE)
+    {
+      if (mode == UNINIT)
+        init_poll ();
+      while (n-- > 0)
+        putc_poll (*buffer++);
+    }
+  else
+    {
+      while (n-- > 0)
+        {
+          if (intq_full (&txq))
+            {
+              /* Let the interrupt handler start draining the
+                 queue.  As in serial_putc(), poll instead if
+                 interrupts are off. */
+              write_ier ();
+              if (old_level == INTR_OFF)
+                putc_poll (intq_getc (&txq));
+            }
+          intq_putc (&txq, *buffer++);
+        }
+      write_ier ();
+    }
+
+  intr_set_level (old_level);
+}
+
 /* Flushes anything in the serial buffer out the port in polling
    mode. */
 void
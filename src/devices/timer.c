@@ -20,11 +20,16 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* Pending alarms, a min-heap on wake-up time.  Protected by
+   disabling interrupts. */
+static struct heap alarm_heap;
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
 static intr_handler_func timer_interrupt;
+static heap_less_func alarm_less;
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
@@ -37,6 +42,7 @@ timer_init (void)
 {
   pit_configure_channel (0, 2, TIMER_FREQ);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
+  heap_init (&alarm_heap, alarm_less, NULL);
 }
 
 /* Calibrates loops_per_tick, used to implement brief delays. */
@@ -89,11 +95,53 @@ timer_elapsed (int64_t then)
 void
 timer_sleep (int64_t ticks) 
 {
-  int64_t start = timer_ticks ();
+  struct timer_alarm alarm;
+  struct semaphore sema;
 
   ASSERT (intr_get_level () == INTR_ON);
-  while (timer_elapsed (start) < ticks) 
-    thread_yield ();
+  if (ticks <= 0)
+    return;
+
+  sema_init (&sema, 0);
+  timer_alarm_set (&alarm, &sema, ticks);
+  sema_down (&sema);
+}
+
+/* Sets ALARM to up SEMA once TICKS timer ticks have passed.  A
+   thread can then wait for either the alarm or some other event
+   by downing SEMA; see timer_sleep() for the simplest case.
+   Unless the alarm has gone off, it must be cancelled with
+   timer_alarm_cancel() before ALARM goes out of scope. */
+void
+timer_alarm_set (struct timer_alarm *alarm, struct semaphore *sema,
+                 int64_t ticks)
+{
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  alarm->wakeup = timer_ticks () + ticks;
+  alarm->sema = sema;
+  heap_push (&alarm_heap, &alarm->elem);
+  intr_set_level (old_level);
+}
+
+/* Cancels ALARM if it has not gone off yet.  Returns true if it
+   had gone off, false if it was cancelled. */
+bool
+timer_alarm_cancel (struct timer_alarm *alarm)
+{
+  enum intr_level old_level;
+  bool fired;
+
+  old_level = intr_disable ();
+  fired = alarm->sema == NULL;
+  if (!fired)
+    {
+      heap_remove (&alarm_heap, &alarm->elem);
+      alarm->sema = NULL;
+    }
+  intr_set_level (old_level);
+  return fired;
 }
 
 /* Sleeps for approximately MS milliseconds.  Interrupts must be
@@ -172,6 +220,17 @@ timer_interrupt (struct intr_frame *args UNUSED)
 {
   ticks++;
   thread_tick ();
+
+  while (!heap_empty (&alarm_heap))
+    {
+      struct timer_alarm *alarm
+        = heap_entry (heap_min (&alarm_heap), struct timer_alarm, elem);
+      if (alarm->wakeup > ticks)
+        break;
+      heap_pop_min (&alarm_heap);
+      sema_up (alarm->sema);
+      alarm->sema = NULL;
+    }
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -244,3 +303,13 @@ real_time_delay (int64_t num, int32_t denom)
   ASSERT (denom % 1000 == 0);
   busy_wait (loops_per_tick * num / 1000 * TIMER_FREQ / (denom / 1000)); 
 }
+
+/* Returns true if alarm A goes off before alarm B. */
+static bool
+alarm_less (const struct heap_elem *a_, const struct heap_elem *b_,
+            void *aux UNUSED)
+{
+  const struct timer_alarm *a = heap_entry (a_, struct timer_alarm, elem);
+  const struct timer_alarm *b = heap_entry (b_, struct timer_alarm, elem);
+  return a->wakeup < b->wakeup;
+}
@@ -1,9 +1,13 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <heap.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+struct semaphore;
+
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
@@ -19,6 +23,18 @@ void timer_msleep (int64_t milliseconds);
 void timer_usleep (int64_t microseconds);
 void timer_nsleep (int64_t nanoseconds);
 
+/* An alarm that ups a semaphore when it goes off. */
+struct timer_alarm
+  {
+    int64_t wakeup;             /* Timer tick at which to go off. */
+    struct semaphore *sema;     /* Semaphore to up, or null once fired. */
+    struct heap_elem elem;      /* Element in the alarm heap. */
+  };
+
+void timer_alarm_set (struct timer_alarm *, struct semaphore *,
+                      int64_t ticks);
+bool timer_alarm_cancel (struct timer_alarm *);
+
 /* Busy waits. */
 void timer_mdelay (int64_t milliseconds);
 void timer_udelay (int64_t microseconds);
@@ -1,12 +1,16 @@
 #include "filesys/buffer_cache.h"
-#include "threads/malloc.h"
+#include "threads/slab.h"
 #include "threads/thread.h"
 #include "devices/timer.h"
 #include "filesys/filesys.h"
 #include <string.h>
 
+// cache of buffer cache entries, which are a bit over a sector each
+static struct slab_cache *entry_cache;
+
 void buffer_cache_init()
 {
+    entry_cache = slab_create("cache_entry", sizeof(struct cache_entry), NULL);
     list_init(&buffer_cache);
     lock_init(&cache_lock);
     cache_num = 0;   // initial number of cache entry = 0
@@ -17,7 +21,7 @@ void buffer_cache_init()
 struct cache_entry* init_cache_entry(block_sector_t sector)
 {
     struct cache_entry* entry = NULL;
-    entry = malloc(sizeof(struct cache_entry));
+    entry = slab_alloc(entry_cache);
     entry->sector = sector;
     entry->dirty = false;
     entry->is_accessed = true; // get_cache_entry call this func, so it's accessed
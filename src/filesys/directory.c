@@ -4,7 +4,7 @@
 #include <list.h>
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
-#include "threads/malloc.h"
+#include "threads/slab.h"
 
 
 
@@ -15,6 +15,9 @@ struct dir
     off_t pos;                          /* Current position. */
   };
 
+/* Cache of open directories. */
+static struct slab_cache *dir_cache;
+
 /* A single directory entry. */
 struct dir_entry 
   {
@@ -33,12 +36,19 @@ dir_create (block_sector_t sector, size_t entry_cnt)
   return inode_create (sector, entry_cnt * sizeof (struct dir_entry), true);
 }
 
+/* Initializes the directory module. */
+void
+dir_init (void)
+{
+  dir_cache = slab_create ("dir", sizeof (struct dir), NULL);
+}
+
 /* Opens and returns the directory for the given INODE, of which
    it takes ownership.  Returns a null pointer on failure. */
 struct dir *
 dir_open (struct inode *inode) 
 {
-  struct dir *dir = calloc (1, sizeof *dir);
+  struct dir *dir = slab_alloc (dir_cache);
   if (inode != NULL && dir != NULL)
     {
       dir->inode = inode;
@@ -48,7 +58,7 @@ dir_open (struct inode *inode)
   else
     {
       inode_close (inode);
-      free (dir);
+      slab_free (dir_cache, dir);
       return NULL; 
     }
 }
@@ -76,7 +86,7 @@ dir_close (struct dir *dir)
   if (dir != NULL)
     {
       inode_close (dir->inode);
-      free (dir);
+      slab_free (dir_cache, dir);
     }
 }
 
@@ -25,6 +25,8 @@ filesys_init (bool format)
     PANIC ("No file system device found, can't initialize file system.");
 
   inode_init ();
+  file_init ();
+  dir_init ();
   free_map_init ();
 
   // my code
@@ -79,9 +81,16 @@ struct file *
 filesys_open (const char *name)
 {
   // struct dir *dir = dir_open_root ();
-  if (strcmp(name, "/") == 0) return (struct file*) dir_open_root();
+  /* Directories are opened as files too; the caller can tell
+     from the inode. */
+  if (strcmp(name, "/") == 0) return file_open (inode_open (ROOT_DIR_SECTOR));
   struct dir* dir = get_parent_dir(name);
-  if (strcmp(name, ".") == 0) return (struct file *) dir;
+  if (strcmp(name, ".") == 0)
+    {
+      struct inode *inode = dir != NULL ? inode_reopen (dir_get_inode (dir)) : NULL;
+      dir_close (dir);
+      return file_open (inode);
+    }
   char* file_name = get_filename(name);
   struct inode *inode = NULL;
 
@@ -12,6 +12,7 @@
 #include "threads/malloc.h"
 #include "filesys/buffer_cache.h"
 #include "threads/thread.h"
+#include "threads/slab.h"
 #include "threads/synch.h"
 
 /* Identifies an inode. */
@@ -140,11 +141,23 @@ byte_to_sector (const struct inode *inode, off_t pos)
    returns the same `struct inode'. */
 static struct list open_inodes;
 
+/* Cache of in-memory inodes. */
+static struct slab_cache *inode_cache;
+
+/* Constructs an in-memory inode in INODE_CACHE. */
+static void
+inode_ctor (void *inode_)
+{
+  struct inode *inode = inode_;
+  lock_init (&inode->extend_lock);
+}
+
 /* Initializes the inode module. */
 void
 inode_init (void) 
 {
   list_init (&open_inodes);
+  inode_cache = slab_create ("inode", sizeof (struct inode), inode_ctor);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -236,7 +249,7 @@ inode_open (block_sector_t sector)
     }
 
   /* Allocate memory. */
-  inode = malloc (sizeof *inode);
+  inode = slab_alloc (inode_cache);
   if (inode == NULL)
     return NULL;
 
@@ -247,8 +260,6 @@ inode_open (block_sector_t sector)
   inode->deny_write_cnt = 0;
   inode->removed = false;
 
-  lock_init(&inode->extend_lock);
-
   struct inode_disk* disk_inode = malloc(sizeof(struct inode_disk));
   // block_read (fs_device, inode->sector, &inode->data);
   
@@ -329,7 +340,7 @@ inode_close (struct inode *inode)
           block_write(fs_device,inode->sector,disk_inode);
           free(disk_inode);
         }
-      free (inode); 
+      slab_free (inode_cache, inode); 
     }
 
 }
@@ -0,0 +1,17 @@
+#ifndef __LIB_FCNTL_H
+#define __LIB_FCNTL_H
+
+/* Commands for the fcntl system call.
+   Shared between the kernel and user programs. */
+#define F_GETFL 1               /* Return the fd's status flags. */
+#define F_SETFL 2               /* Set the fd's status flags. */
+#define F_GETFD 3               /* Return the fd's descriptor flags. */
+#define F_SETFD 4               /* Set the fd's descriptor flags. */
+
+/* Status flags. */
+#define O_NONBLOCK 0x800        /* Fail instead of waiting. */
+
+/* Descriptor flags. */
+#define FD_CLOEXEC 1            /* Close in the new program on exec. */
+
+#endif /* lib/fcntl.h */
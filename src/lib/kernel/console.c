@@ -1,14 +1,20 @@
 #include <console.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include "devices/serial.h"
 #include "devices/vga.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 
-static void vprintf_helper (char, void *);
-static void putchar_have_lock (uint8_t c);
+static void vprintf_helper (const char *, size_t, void *);
+static void putbuf_have_lock (const char *, size_t);
+static size_t ring_put (const char *, size_t);
+static void drain_ring (void);
+static bool pending_put (const char *, size_t);
+static void flush_pending (void);
+static void unlock_and_drain (void);
 
 /* The console lock.
    Both the vga and serial layers do their own locking, so it's
@@ -59,6 +65,37 @@ static int console_lock_depth;
 /* Number of characters written to console. */
 static int64_t write_cnt;
 
+/* Output ring.
+
+   Characters written to the console are first queued here and
+   then sent to the serial port and vga display in batches, so
+   that each device is locked and updated once per batch rather
+   than once per character.  The ring is drained by whoever holds
+   the console lock, before releasing it.
+
+   The ring is protected by disabling interrupts. */
+#define RING_SIZE 1024                  /* Ring capacity, in bytes. */
+#define DRAIN_CHUNK 128                 /* Bytes sent per device call. */
+static char ring[RING_SIZE];
+static size_t ring_head;                /* Total bytes ever queued. */
+static size_t ring_tail;                /* Total bytes ever drained. */
+
+/* Pending output.
+
+   A writer that does not want to wait for the console lock (see
+   console_write_nonblocking()) queues its output here, not in
+   the output ring, while another thread holds the lock.  The
+   lock holder moves it into the ring only once its own output is
+   complete, when it acquires or releases the lock, so that
+   neither the holder's output nor any pending write is split by
+   the other.
+
+   Also protected by disabling interrupts. */
+#define PENDING_SIZE 1024               /* Capacity, in bytes. */
+static char pending[PENDING_SIZE];
+static size_t pending_head;             /* Total bytes ever queued. */
+static size_t pending_tail;             /* Total bytes ever moved. */
+
 /* Enable console locking. */
 void
 console_init (void) 
@@ -83,7 +120,8 @@ console_print_stats (void)
   printf ("Console: %lld characters output\n", write_cnt);
 }
 
-/* Acquires the console lock. */
+/* Acquires the console lock.  Pending output queued before we
+   got the lock goes out ahead of ours. */
 static void
 acquire_console (void) 
 {
@@ -92,11 +130,15 @@ acquire_console (void)
       if (lock_held_by_current_thread (&console_lock)) 
         console_lock_depth++; 
       else
-        lock_acquire (&console_lock); 
+        {
+          lock_acquire (&console_lock); 
+          flush_pending ();
+        }
     }
 }
 
-/* Releases the console lock. */
+/* Releases the console lock, first sending any queued output
+   to the devices. */
 static void
 release_console (void) 
 {
@@ -105,8 +147,10 @@ release_console (void)
       if (console_lock_depth > 0)
         console_lock_depth--;
       else
-        lock_release (&console_lock); 
+        unlock_and_drain ();
     }
+  else
+    drain_ring ();
 }
 
 /* Returns true if the current thread has the console lock,
@@ -140,9 +184,8 @@ int
 puts (const char *s) 
 {
   acquire_console ();
-  while (*s != '\0')
-    putchar_have_lock (*s++);
-  putchar_have_lock ('\n');
+  putbuf_have_lock (s, strlen (s));
+  putbuf_have_lock ("\n", 1);
   release_console ();
 
   return 0;
@@ -153,17 +196,40 @@ void
 putbuf (const char *buffer, size_t n) 
 {
   acquire_console ();
-  while (n-- > 0)
-    putchar_have_lock (*buffer++);
+  putbuf_have_lock (buffer, n);
   release_console ();
 }
 
+/* Writes the N characters in BUFFER to the console without
+   waiting for the console lock if another thread holds it.  In
+   that case the characters are queued as pending output, which
+   the lock holder sends out after its own, and never in the
+   middle of it.  Only if BUFFER does not fit whole in the pending
+   buffer does this wait for the lock, like putbuf().  Output from
+   a single caller is never reordered or split. */
+void
+console_write_nonblocking (const char *buffer, size_t n) 
+{
+  if (intr_context () || !use_console_lock
+      || lock_held_by_current_thread (&console_lock)
+      || !pending_put (buffer, n))
+    {
+      putbuf (buffer, n);
+      return;
+    }
+
+  if (lock_try_acquire (&console_lock))
+    unlock_and_drain ();
+}
+
 /* Writes C to the vga display and serial port. */
 int
 putchar (int c) 
 {
+  char ch = c;
+
   acquire_console ();
-  putchar_have_lock (c);
+  putbuf_have_lock (&ch, 1);
   release_console ();
   
   return c;
@@ -171,21 +237,139 @@ putchar (int c)
 
 /* Helper function for vprintf(). */
 static void
-vprintf_helper (char c, void *char_cnt_) 
+vprintf_helper (const char *s, size_t n, void *char_cnt_) 
 {
   int *char_cnt = char_cnt_;
-  (*char_cnt)++;
-  putchar_have_lock (c);
+  *char_cnt += n;
+  putbuf_have_lock (s, n);
 }
 
-/* Writes C to the vga display and serial port.
-   The caller has already acquired the console lock if
+/* Queues the N characters in BUFFER for the vga display and
+   serial port, draining the ring whenever it fills up.  The
+   caller has already acquired the console lock if
    appropriate. */
 static void
-putchar_have_lock (uint8_t c) 
+putbuf_have_lock (const char *buffer, size_t n) 
 {
   ASSERT (console_locked_by_current_thread ());
-  write_cnt++;
-  serial_putc (c);
-  vga_putc (c);
+  for (;;)
+    {
+      size_t cnt = ring_put (buffer, n);
+      buffer += cnt;
+      n -= cnt;
+      if (n == 0)
+        break;
+      drain_ring ();
+    }
+}
+
+/* Queues as many of the N bytes in BUFFER in the output ring as
+   fit and returns the number queued. */
+static size_t
+ring_put (const char *buffer, size_t n) 
+{
+  enum intr_level old_level = intr_disable ();
+  size_t cnt = 0;
+
+  /* Copy in at most two runs, split where the ring wraps. */
+  while (cnt < n && ring_head - ring_tail < RING_SIZE)
+    {
+      size_t ofs = ring_head % RING_SIZE;
+      size_t chunk = RING_SIZE - (ring_head - ring_tail);
+
+      if (chunk > RING_SIZE - ofs)
+        chunk = RING_SIZE - ofs;
+      if (chunk > n - cnt)
+        chunk = n - cnt;
+      memcpy (ring + ofs, buffer + cnt, chunk);
+      ring_head += chunk;
+      cnt += chunk;
+    }
+  write_cnt += cnt;
+  intr_set_level (old_level);
+
+  return cnt;
+}
+
+/* Sends everything in the output ring to the serial port and vga
+   display, DRAIN_CHUNK bytes at a time.  The caller has already
+   acquired the console lock if appropriate. */
+static void
+drain_ring (void) 
+{
+  for (;;)
+    {
+      char chunk[DRAIN_CHUNK];
+      enum intr_level old_level;
+      size_t cnt = 0;
+
+      old_level = intr_disable ();
+      while (cnt < DRAIN_CHUNK && ring_tail != ring_head)
+        chunk[cnt++] = ring[ring_tail++ % RING_SIZE];
+      intr_set_level (old_level);
+
+      if (cnt == 0)
+        break;
+      serial_putbuf ((const uint8_t *) chunk, cnt);
+      vga_putbuf (chunk, cnt);
+    }
+}
+
+/* Queues all N bytes in BUFFER as pending output and returns
+   true, or returns false without queuing any if they do not all
+   fit. */
+static bool
+pending_put (const char *buffer, size_t n) 
+{
+  enum intr_level old_level = intr_disable ();
+  bool fits = n <= PENDING_SIZE - (pending_head - pending_tail);
+  size_t i;
+
+  if (fits)
+    for (i = 0; i < n; i++)
+      pending[pending_head++ % PENDING_SIZE] = buffer[i];
+  intr_set_level (old_level);
+
+  return fits;
+}
+
+/* Moves all pending output into the output ring, in the order
+   it was queued.  The caller holds the console lock. */
+static void
+flush_pending (void) 
+{
+  for (;;)
+    {
+      char chunk[DRAIN_CHUNK];
+      enum intr_level old_level;
+      size_t cnt = 0;
+
+      old_level = intr_disable ();
+      while (cnt < DRAIN_CHUNK && pending_tail != pending_head)
+        chunk[cnt++] = pending[pending_tail++ % PENDING_SIZE];
+      intr_set_level (old_level);
+
+      if (cnt == 0)
+        break;
+      putbuf_have_lock (chunk, cnt);
+    }
+}
+
+/* Sends out the output ring and then any pending output, and
+   releases the console lock, which the caller holds.  Output
+   queued by a non-blocking writer after that but before the
+   release would otherwise wait for the next console user, so if
+   there is any, take the lock back (if no one else has) and send
+   it too. */
+static void
+unlock_and_drain (void) 
+{
+  do
+    {
+      flush_pending ();
+      drain_ring ();
+      lock_release (&console_lock);
+    }
+  while (pending_tail != pending_head
+         && lock_try_acquire (&console_lock));
 }
@@ -19,6 +19,13 @@ static void insert_elem (struct hash *, struct list *, struct hash_elem *);
 static void remove_elem (struct hash *, struct hash_elem *);
 static void rehash (struct hash *);
 
+static struct hash_slot *open_find (struct hash *, struct hash_elem *,
+                                    unsigned hash);
+static bool open_insert (struct hash *, struct hash_elem *, unsigned hash);
+static void open_remove (struct hash *, struct hash_slot *);
+static bool open_resize (struct hash *, size_t slot_cnt);
+static void open_rehash (struct hash *);
+
 /* Initializes hash table H to compute hash values using HASH and
    compare hash elements using LESS, given auxiliary data AUX. */
 bool
@@ -28,6 +35,7 @@ hash_init (struct hash *h,
   h->elem_cnt = 0;
   h->bucket_cnt = 4;
   h->buckets = malloc (sizeof *h->buckets * h->bucket_cnt);
+  h->slots = NULL;
   h->hash = hash;
   h->less = less;
   h->aux = aux;
@@ -41,6 +49,25 @@ hash_init (struct hash *h,
     return false;
 }
 
+/* Smallest number of slots in an open-addressing table. */
+#define MIN_SLOTS 16
+
+/* Initializes hash table H like hash_init(), but to use open
+   addressing instead of chaining.  See hash.h for details. */
+bool
+hash_init_open (struct hash *h,
+                hash_hash_func *hash, hash_less_func *less, void *aux) 
+{
+  h->elem_cnt = 0;
+  h->bucket_cnt = 0;
+  h->buckets = NULL;
+  h->slots = NULL;
+  h->hash = hash;
+  h->less = less;
+  h->aux = aux;
+  return open_resize (h, MIN_SLOTS);
+}
+
 /* Removes all the elements from H.
    
    If DESTRUCTOR is non-null, then it is called for each element
@@ -55,6 +82,20 @@ hash_clear (struct hash *h, hash_action_func *destructor)
 {
   size_t i;
 
+  if (h->slots != NULL)
+    {
+      for (i = 0; i < h->bucket_cnt; i++)
+        {
+          struct hash_elem *e = h->slots[i].elem;
+
+          h->slots[i].elem = NULL;
+          if (e != NULL && destructor != NULL)
+            destructor (e, h->aux);
+        }
+      h->elem_cnt = 0;
+      return;
+    }
+
   for (i = 0; i < h->bucket_cnt; i++) 
     {
       struct list *bucket = &h->buckets[i];
@@ -89,17 +130,33 @@ hash_destroy (struct hash *h, hash_action_func *destructor)
   if (destructor != NULL)
     hash_clear (h, destructor);
   free (h->buckets);
+  free (h->slots);
 }
 
 /* Inserts NEW into hash table H and returns a null pointer, if
    no equal element is already in the table.
    If an equal element is already in the table, returns it
-   without inserting NEW. */   
+   without inserting NEW.
+   An open-addressing table can fill up if memory is too short
+   for it to grow; then NEW itself is returned, not inserted. */   
 struct hash_elem *
 hash_insert (struct hash *h, struct hash_elem *new)
 {
-  struct list *bucket = find_bucket (h, new);
-  struct hash_elem *old = find_elem (h, bucket, new);
+  struct list *bucket;
+  struct hash_elem *old;
+
+  if (h->slots != NULL)
+    {
+      unsigned hash = h->hash (new, h->aux);
+      struct hash_slot *s = open_find (h, new, hash);
+
+      if (s != NULL)
+        return s->elem;
+      return open_insert (h, new, hash) ? NULL : new;
+    }
+
+  bucket = find_bucket (h, new);
+  old = find_elem (h, bucket, new);
 
   if (old == NULL) 
     insert_elem (h, bucket, new);
@@ -110,12 +167,32 @@ hash_insert (struct hash *h, struct hash_elem *new)
 }
 
 /* Inserts NEW into hash table H, replacing any equal element
-   already in the table, which is returned. */
+   already in the table, which is returned.
+   If an open-addressing table has no equal element and is full,
+   as for hash_insert(), returns NEW itself without inserting
+   it. */
 struct hash_elem *
 hash_replace (struct hash *h, struct hash_elem *new) 
 {
-  struct list *bucket = find_bucket (h, new);
-  struct hash_elem *old = find_elem (h, bucket, new);
+  struct list *bucket;
+  struct hash_elem *old;
+
+  if (h->slots != NULL)
+    {
+      unsigned hash = h->hash (new, h->aux);
+      struct hash_slot *s = open_find (h, new, hash);
+
+      if (s != NULL)
+        {
+          old = s->elem;
+          s->elem = new;
+          return old;
+        }
+      return open_insert (h, new, hash) ? NULL : new;
+    }
+
+  bucket = find_bucket (h, new);
+  old = find_elem (h, bucket, new);
 
   if (old != NULL)
     remove_elem (h, old);
@@ -131,6 +208,11 @@ hash_replace (struct hash *h, struct hash_elem *new)
 struct hash_elem *
 hash_find (struct hash *h, struct hash_elem *e) 
 {
+  if (h->slots != NULL)
+    {
+      struct hash_slot *s = open_find (h, e, h->hash (e, h->aux));
+      return s != NULL ? s->elem : NULL;
+    }
   return find_elem (h, find_bucket (h, e), e);
 }
 
@@ -144,7 +226,21 @@ hash_find (struct hash *h, struct hash_elem *e)
 struct hash_elem *
 hash_delete (struct hash *h, struct hash_elem *e)
 {
-  struct hash_elem *found = find_elem (h, find_bucket (h, e), e);
+  struct hash_elem *found;
+
+  if (h->slots != NULL)
+    {
+      struct hash_slot *s = open_find (h, e, h->hash (e, h->aux));
+
+      if (s == NULL)
+        return NULL;
+      found = s->elem;
+      open_remove (h, s);
+      open_rehash (h);
+      return found;
+    }
+
+  found = find_elem (h, find_bucket (h, e), e);
   if (found != NULL) 
     {
       remove_elem (h, found);
@@ -166,6 +262,14 @@ hash_apply (struct hash *h, hash_action_func *action)
   
   ASSERT (action != NULL);
 
+  if (h->slots != NULL)
+    {
+      for (i = 0; i < h->bucket_cnt; i++)
+        if (h->slots[i].elem != NULL)
+          action (h->slots[i].elem, h->aux);
+      return;
+    }
+
   for (i = 0; i < h->bucket_cnt; i++) 
     {
       struct list *bucket = &h->buckets[i];
@@ -203,6 +307,13 @@ hash_first (struct hash_iterator *i, struct hash *h)
   ASSERT (h != NULL);
 
   i->hash = h;
+  if (h->slots != NULL)
+    {
+      i->bucket = NULL;
+      i->elem = NULL;
+      i->slot = (size_t) -1;
+      return;
+    }
   i->bucket = i->hash->buckets;
   i->elem = list_elem_to_hash_elem (list_head (i->bucket));
 }
@@ -220,6 +331,20 @@ hash_next (struct hash_iterator *i)
 {
   ASSERT (i != NULL);
 
+  if (i->hash->slots != NULL)
+    {
+      struct hash *h = i->hash;
+
+      i->elem = NULL;
+      while (++i->slot < h->bucket_cnt)
+        if (h->slots[i->slot].elem != NULL)
+          {
+            i->elem = h->slots[i->slot].elem;
+            break;
+          }
+      return i->elem;
+    }
+
   i->elem = list_elem_to_hash_elem (list_next (&i->elem->list_elem));
   while (i->elem == list_elem_to_hash_elem (list_end (i->bucket)))
     {
@@ -428,3 +553,149 @@ remove_elem (struct hash *h, struct hash_elem *e)
   list_remove (&e->list_elem);
 }
 
+
+/* Open addressing. */
+
+/* Returns how far slot S in H is from the home slot of the
+   element in it. */
+static inline size_t
+probe_dist (const struct hash *h, const struct hash_slot *s)
+{
+  return ((size_t) (s - h->slots) - s->hash) & (h->bucket_cnt - 1);
+}
+
+/* Returns the slot in H after S, wrapping around. */
+static inline struct hash_slot *
+next_slot (const struct hash *h, struct hash_slot *s)
+{
+  return ++s < h->slots + h->bucket_cnt ? s : h->slots;
+}
+
+/* Returns the slot in H that holds an element equal to E, whose
+   hash value is HASH, or a null pointer if there is none.  The
+   probe stops at an empty slot, or at one whose element is
+   closer to its home than E would be, since Robin Hood ordering
+   would have put E there. */
+static struct hash_slot *
+open_find (struct hash *h, struct hash_elem *e, unsigned hash)
+{
+  struct hash_slot *s = &h->slots[hash & (h->bucket_cnt - 1)];
+  size_t dist;
+
+  for (dist = 0; s->elem != NULL && probe_dist (h, s) >= dist; dist++)
+    {
+      if (s->hash == hash
+          && !h->less (s->elem, e, h->aux) && !h->less (e, s->elem, h->aux))
+        return s;
+      s = next_slot (h, s);
+    }
+  return NULL;
+}
+
+/* Places E, with hash value HASH, into H, which must have an
+   empty slot and no element equal to E, without resizing. */
+static void
+place_elem (struct hash *h, struct hash_elem *e, unsigned hash)
+{
+  struct hash_slot *s = &h->slots[hash & (h->bucket_cnt - 1)];
+  size_t dist;
+
+  for (dist = 0; s->elem != NULL; dist++)
+    {
+      /* Take the slot from an element that is closer to home,
+         and go on to find a place for that one instead. */
+      size_t s_dist = probe_dist (h, s);
+      if (s_dist < dist)
+        {
+          struct hash_slot tmp = *s;
+          s->elem = e;
+          s->hash = hash;
+          e = tmp.elem;
+          hash = tmp.hash;
+          dist = s_dist;
+        }
+      s = next_slot (h, s);
+    }
+  s->elem = e;
+  s->hash = hash;
+}
+
+/* Inserts E, with hash value HASH, into H, which must not
+   contain an element equal to E, growing H first if it is
+   getting full.  Returns false only if H is full and cannot
+   grow. */
+static bool
+open_insert (struct hash *h, struct hash_elem *e, unsigned hash)
+{
+  open_rehash (h);
+  if (h->elem_cnt + 1 >= h->bucket_cnt)
+    return false;
+  place_elem (h, e, hash);
+  h->elem_cnt++;
+  return true;
+}
+
+/* Removes the element in slot S from H, shifting the elements
+   that follow it in the same run back by one slot, so that no
+   probe can stop early at a hole. */
+static void
+open_remove (struct hash *h, struct hash_slot *s)
+{
+  struct hash_slot *next;
+
+  for (next = next_slot (h, s); next->elem != NULL && probe_dist (h, next) > 0;
+       next = next_slot (h, next))
+    {
+      *s = *next;
+      s = next;
+    }
+  s->elem = NULL;
+  h->elem_cnt--;
+}
+
+/* Load factor limits, in elements per 8 slots. */
+#define MAX_LOAD_EIGHTHS 6      /* More than 3/4 full: grow. */
+#define MIN_LOAD_EIGHTHS 1      /* Less than 1/8 full: shrink. */
+
+/* Changes the number of slots in H to SLOT_CNT, a power of 2,
+   and moves every element into its new place.  Returns false,
+   leaving H unchanged, if memory is short. */
+static bool
+open_resize (struct hash *h, size_t slot_cnt)
+{
+  struct hash_slot *old_slots = h->slots;
+  size_t old_cnt = h->bucket_cnt;
+  size_t i;
+
+  ASSERT (is_power_of_2 (slot_cnt));
+  ASSERT (slot_cnt > h->elem_cnt);
+
+  h->slots = malloc (sizeof *h->slots * slot_cnt);
+  if (h->slots == NULL)
+    {
+      h->slots = old_slots;
+      return false;
+    }
+  h->bucket_cnt = slot_cnt;
+  for (i = 0; i < slot_cnt; i++)
+    h->slots[i].elem = NULL;
+
+  for (i = 0; i < old_cnt; i++)
+    if (old_slots[i].elem != NULL)
+      place_elem (h, old_slots[i].elem, old_slots[i].hash);
+  free (old_slots);
+  return true;
+}
+
+/* Grows H if it is getting full, or shrinks it if it is mostly
+   empty.  Failing to grow for lack of memory is not an error, as
+   long as there is a free slot left. */
+static void
+open_rehash (struct hash *h)
+{
+  if ((h->elem_cnt + 1) * 8 > h->bucket_cnt * MAX_LOAD_EIGHTHS)
+    open_resize (h, h->bucket_cnt * 2);
+  else if (h->bucket_cnt > MIN_SLOTS
+           && h->elem_cnt * 8 < h->bucket_cnt * MIN_LOAD_EIGHTHS)
+    open_resize (h, h->bucket_cnt / 2);
+}
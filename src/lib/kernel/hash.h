@@ -18,7 +18,17 @@
    conversion from a struct hash_elem back to a structure object
    that contains it.  This is the same technique used in the
    linked list implementation.  Refer to lib/kernel/list.h for a
-   detailed explanation. */
+   detailed explanation.
+
+   A table initialized with hash_init_open() instead uses open
+   addressing: a single array of slots, each holding an element
+   pointer and its hash value, searched by linear probing with
+   Robin Hood ordering (an element never sits further from its
+   home slot than the element it displaced).  A lookup then walks
+   a short run of adjacent slots and calls the comparison
+   function only for elements whose full hash value matches,
+   instead of chasing a chain of list pointers.  Both kinds of
+   table use the same functions and the same struct hash_elem. */
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -55,12 +65,21 @@ typedef bool hash_less_func (const struct hash_elem *a,
    data AUX. */
 typedef void hash_action_func (struct hash_elem *e, void *aux);
 
+/* Slot in an open-addressing hash table. */
+struct hash_slot
+  {
+    unsigned hash;              /* Hash value of ELEM. */
+    struct hash_elem *elem;     /* Element, or null if slot is empty. */
+  };
+
 /* Hash table. */
 struct hash 
   {
     size_t elem_cnt;            /* Number of elements in table. */
-    size_t bucket_cnt;          /* Number of buckets, a power of 2. */
+    size_t bucket_cnt;          /* Number of buckets or slots, a power of 2. */
     struct list *buckets;       /* Array of `bucket_cnt' lists. */
+    struct hash_slot *slots;    /* Open addressing: array of `bucket_cnt'
+                                   slots, or null for chaining. */
     hash_hash_func *hash;       /* Hash function. */
     hash_less_func *less;       /* Comparison function. */
     void *aux;                  /* Auxiliary data for `hash' and `less'. */
@@ -72,10 +91,13 @@ struct hash_iterator
     struct hash *hash;          /* The hash table. */
     struct list *bucket;        /* Current bucket. */
     struct hash_elem *elem;     /* Current hash element in current bucket. */
+    size_t slot;                /* Current slot, for open addressing. */
   };
 
 /* Basic life cycle. */
 bool hash_init (struct hash *, hash_hash_func *, hash_less_func *, void *aux);
+bool hash_init_open (struct hash *, hash_hash_func *, hash_less_func *,
+                     void *aux);
 void hash_clear (struct hash *, hash_action_func *);
 void hash_destroy (struct hash *, hash_action_func *);
 
@@ -0,0 +1,218 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* Every element in a pairing heap is the root of a subtree whose
+   children form a doubly linked sibling list, leftmost first.
+   The leftmost child's `prev' points to its parent instead of a
+   sibling, so that any element can be cut out of the tree in
+   O(1) time given only a pointer to it.  The root's `prev' and
+   `next' are null.
+
+   Two trees are combined by "linking" them: the root with the
+   greater value becomes the leftmost child of the other.  Every
+   operation is built from links:
+
+     - Push links the new element with the root.
+
+     - Decrease cuts the element's subtree out of the tree and
+       links it with the root.
+
+     - Pop discards the root and combines its children in two
+       passes: first link them in pairs from left to right, then
+       link the pairs together from right to left.  This pairing
+       is what gives the heap its amortized O(lg n) bound.
+
+   None of the operations recurse, so a degenerate heap cannot
+   overflow a kernel stack. */
+
+/* Returns true if E is the leftmost child of its parent. */
+static inline bool
+is_leftmost (const struct heap_elem *e)
+{
+  return e->prev->child == e;
+}
+
+/* Links the trees rooted at A and B and returns the root of the
+   result.  On a tie, A stays on top. */
+static struct heap_elem *
+link (struct heap *h, struct heap_elem *a, struct heap_elem *b)
+{
+  if (h->less (b, a, h->aux))
+    {
+      struct heap_elem *t = a;
+      a = b;
+      b = t;
+    }
+
+  b->prev = a;
+  b->next = a->child;
+  if (a->child != NULL)
+    a->child->prev = b;
+  a->child = b;
+  return a;
+}
+
+/* Cuts the subtree rooted at E, which must not be the heap's
+   root, out of its parent's list of children. */
+static void
+cut (struct heap_elem *e)
+{
+  if (is_leftmost (e))
+    e->prev->child = e->next;
+  else
+    e->prev->next = e->next;
+  if (e->next != NULL)
+    e->next->prev = e->prev;
+  e->prev = e->next = NULL;
+}
+
+/* Combines the list of sibling trees that starts at FIRST into a
+   single tree and returns its root, or a null pointer if FIRST is
+   null. */
+static struct heap_elem *
+merge_pairs (struct heap *h, struct heap_elem *first)
+{
+  struct heap_elem *pairs = NULL;
+  struct heap_elem *root;
+
+  if (first == NULL)
+    return NULL;
+
+  /* Link siblings in pairs from left to right, stacking each
+     result on PAIRS through its `next' member. */
+  while (first != NULL)
+    {
+      struct heap_elem *a = first;
+      struct heap_elem *b = a->next;
+
+      if (b == NULL)
+        first = NULL;
+      else
+        {
+          first = b->next;
+          a = link (h, a, b);
+        }
+      a->next = pairs;
+      pairs = a;
+    }
+
+  /* Link the pairs together from right to left. */
+  root = pairs;
+  pairs = pairs->next;
+  while (pairs != NULL)
+    {
+      struct heap_elem *next = pairs->next;
+      root = link (h, root, pairs);
+      pairs = next;
+    }
+
+  root->prev = root->next = NULL;
+  return root;
+}
+
+/* Initializes heap H as an empty heap ordered by LESS given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *h, heap_less_func *less, void *aux)
+{
+  ASSERT (h != NULL);
+  ASSERT (less != NULL);
+
+  h->root = NULL;
+  h->elem_cnt = 0;
+  h->less = less;
+  h->aux = aux;
+}
+
+/* Inserts E into heap H.  Among elements that compare equal, E
+   does not displace the current minimum. */
+void
+heap_push (struct heap *h, struct heap_elem *e)
+{
+  ASSERT (h != NULL);
+  ASSERT (e != NULL);
+
+  e->child = e->next = e->prev = NULL;
+  h->root = h->root != NULL ? link (h, h->root, e) : e;
+  h->elem_cnt++;
+}
+
+/* Removes and returns the minimum element of heap H, which must
+   not be empty. */
+struct heap_elem *
+heap_pop_min (struct heap *h)
+{
+  struct heap_elem *min;
+
+  ASSERT (h != NULL);
+  ASSERT (h->root != NULL);
+
+  min = h->root;
+  h->root = merge_pairs (h, min->child);
+  h->elem_cnt--;
+  return min;
+}
+
+/* Removes element E, which must be in heap H, from H. */
+void
+heap_remove (struct heap *h, struct heap_elem *e)
+{
+  struct heap_elem *children;
+
+  ASSERT (h != NULL);
+  ASSERT (e != NULL);
+
+  if (e == h->root)
+    {
+      heap_pop_min (h);
+      return;
+    }
+
+  cut (e);
+  children = merge_pairs (h, e->child);
+  if (children != NULL)
+    h->root = link (h, h->root, children);
+  h->elem_cnt--;
+}
+
+/* Restores the heap property after the key of element E, which
+   must be in heap H, has decreased. */
+void
+heap_decrease (struct heap *h, struct heap_elem *e)
+{
+  ASSERT (h != NULL);
+  ASSERT (e != NULL);
+
+  if (e != h->root)
+    {
+      cut (e);
+      h->root = link (h, h->root, e);
+    }
+}
+
+/* Returns the minimum element of heap H, which must not be
+   empty. */
+struct heap_elem *
+heap_min (struct heap *h)
+{
+  ASSERT (h != NULL);
+  ASSERT (h->root != NULL);
+
+  return h->root;
+}
+
+/* Returns the number of elements in heap H. */
+size_t
+heap_size (struct heap *h)
+{
+  ASSERT (h != NULL);
+  return h->elem_cnt;
+}
+
+/* Returns true if heap H is empty, false otherwise. */
+bool
+heap_empty (struct heap *h)
+{
+  ASSERT (h != NULL);
+  return h->root == NULL;
+}
@@ -0,0 +1,98 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue (min-heap).
+
+   This is a pairing heap: a tree in which every element is no
+   greater than its children, kept as a leftmost-child,
+   right-sibling tree.  Inserting an element, finding the minimum
+   and decreasing an element's key take O(1) time; removing the
+   minimum or an arbitrary element takes O(lg n) amortized time.
+   Compare list_insert_ordered() and list_min(), which take O(n).
+
+   Like lists and hash tables, heaps do not use dynamic
+   allocation.  Instead, each structure that can potentially be
+   in a heap must embed a struct heap_elem member, and the
+   heap_entry macro converts a struct heap_elem back to the
+   structure object that contains it.  Refer to lib/kernel/list.h
+   for a detailed explanation of the technique.
+
+   For example, a queue of `struct foo' ordered by `key':
+
+      struct foo
+        {
+          struct heap_elem elem;
+          int64_t key;
+        };
+
+      static bool
+      foo_less (const struct heap_elem *a, const struct heap_elem *b,
+                void *aux UNUSED)
+      {
+        return (heap_entry (a, struct foo, elem)->key
+                < heap_entry (b, struct foo, elem)->key);
+      }
+
+      struct heap foo_heap;
+      heap_init (&foo_heap, foo_less, NULL);
+
+   An element's key must not change while the element is in a
+   heap, except that it may decrease if heap_decrease() is called
+   right afterward.  To increase a key, remove the element, change
+   the key, and push it again.
+
+   Elements that compare equal come out in no particular order.
+   Callers that need first-in, first-out order among equals should
+   break ties with a sequence number. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem
+  {
+    struct heap_elem *child;    /* Leftmost child. */
+    struct heap_elem *next;     /* Right sibling. */
+    struct heap_elem *prev;     /* Left sibling, or parent if leftmost. */
+  };
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element.  See the big comment at the top of the
+   file for an example. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)           \
+        ((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->next     \
+                     - offsetof (STRUCT, MEMBER.next)))
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap
+  {
+    struct heap_elem *root;     /* Minimum element, or null if empty. */
+    size_t elem_cnt;            /* Number of elements. */
+    heap_less_func *less;       /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `less'. */
+  };
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+
+/* Insertion and removal. */
+void heap_push (struct heap *, struct heap_elem *);
+struct heap_elem *heap_pop_min (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+void heap_decrease (struct heap *, struct heap_elem *);
+
+/* Heap properties. */
+struct heap_elem *heap_min (struct heap *);
+size_t heap_size (struct heap *);
+bool heap_empty (struct heap *);
+
+#endif /* lib/kernel/heap.h */
@@ -0,0 +1,465 @@
+#include "rbtree.h"
+#include "../debug.h"
+
+/* This is the classic red-black tree of Cormen, Leiserson,
+   Rivest, and Stein, "Introduction to Algorithms", chapter 13,
+   with null pointers in place of the black sentinel leaves.  The
+   tree obeys these rules, which keep every path from the root to
+   a leaf within a factor of two of every other:
+
+     1. The root is black.
+
+     2. A red node has no red children.
+
+     3. Every path from a node down to a null leaf passes through
+        the same number of black nodes.
+
+   Insertion and deletion may break rules 1 and 2 or 3 locally,
+   and then repair them by recoloring and rotating on the way back
+   up toward the root.  None of the operations recurse. */
+
+static void rotate_left (struct rb_tree *, struct rb_elem *);
+static void rotate_right (struct rb_tree *, struct rb_elem *);
+static void insert_fixup (struct rb_tree *, struct rb_elem *);
+static void remove_fixup (struct rb_tree *, struct rb_elem *,
+                          struct rb_elem *parent);
+
+/* Returns true if E is a red node, false if it is black or a
+   null leaf. */
+static inline bool
+is_red (const struct rb_elem *e)
+{
+  return e != NULL && e->red;
+}
+
+/* Returns the leftmost element in the subtree rooted at E. */
+static struct rb_elem *
+leftmost (struct rb_elem *e)
+{
+  while (e->left != NULL)
+    e = e->left;
+  return e;
+}
+
+/* Returns the rightmost element in the subtree rooted at E. */
+static struct rb_elem *
+rightmost (struct rb_elem *e)
+{
+  while (e->right != NULL)
+    e = e->right;
+  return e;
+}
+
+/* Initializes tree T as an empty tree ordered by LESS given
+   auxiliary data AUX. */
+void
+rb_init (struct rb_tree *t, rb_less_func *less, void *aux)
+{
+  ASSERT (t != NULL);
+  ASSERT (less != NULL);
+
+  t->root = NULL;
+  t->elem_cnt = 0;
+  t->less = less;
+  t->aux = aux;
+}
+
+/* Inserts NEW into tree T and returns a null pointer, if no
+   equal element is already in the tree.
+   If an equal element is already in the tree, returns it
+   without inserting NEW. */
+struct rb_elem *
+rb_insert (struct rb_tree *t, struct rb_elem *new)
+{
+  struct rb_elem **link = &t->root;
+  struct rb_elem *parent = NULL;
+
+  while (*link != NULL)
+    {
+      parent = *link;
+      if (t->less (new, parent, t->aux))
+        link = &parent->left;
+      else if (t->less (parent, new, t->aux))
+        link = &parent->right;
+      else
+        return parent;
+    }
+
+  new->parent = parent;
+  new->left = new->right = NULL;
+  new->red = true;
+  *link = new;
+  insert_fixup (t, new);
+  t->elem_cnt++;
+  return NULL;
+}
+
+/* Finds and returns an element equal to E in tree T, or a null
+   pointer if no equal element exists in the tree. */
+struct rb_elem *
+rb_find (struct rb_tree *t, const struct rb_elem *e)
+{
+  struct rb_elem *found = rb_lower_bound (t, e);
+  return found != NULL && !t->less (e, found, t->aux) ? found : NULL;
+}
+
+/* Finds, removes, and returns an element equal to E in tree T.
+   Returns a null pointer if no equal element existed in the
+   tree. */
+struct rb_elem *
+rb_delete (struct rb_tree *t, const struct rb_elem *e)
+{
+  struct rb_elem *found = rb_find (t, e);
+  if (found != NULL)
+    rb_remove (t, found);
+  return found;
+}
+
+/* Makes NEW take OLD's place as a child of PARENT, or as the
+   root of T if PARENT is null.  Does not touch NEW->parent. */
+static void
+replace_child (struct rb_tree *t, struct rb_elem *parent,
+               struct rb_elem *old, struct rb_elem *new)
+{
+  if (parent == NULL)
+    t->root = new;
+  else if (parent->left == old)
+    parent->left = new;
+  else
+    parent->right = new;
+}
+
+/* Removes element E, which must be in tree T, from T. */
+void
+rb_remove (struct rb_tree *t, struct rb_elem *e)
+{
+  struct rb_elem *y;            /* Node actually unlinked. */
+  struct rb_elem *x;            /* Child that takes Y's place. */
+  struct rb_elem *x_parent;     /* X's new parent, since X may be null. */
+  bool y_red;
+
+  ASSERT (t != NULL);
+  ASSERT (e != NULL);
+  ASSERT (t->elem_cnt > 0);
+
+  /* If E has two children, unlink its successor, which has no
+     left child, and then move the successor into E's place. */
+  y = e->left == NULL || e->right == NULL ? e : leftmost (e->right);
+  x = y->left != NULL ? y->left : y->right;
+  x_parent = y->parent;
+  y_red = y->red;
+
+  if (x != NULL)
+    x->parent = x_parent;
+  replace_child (t, x_parent, y, x);
+
+  if (y != e)
+    {
+      if (x_parent == e)
+        x_parent = y;
+      y->parent = e->parent;
+      y->left = e->left;
+      y->right = e->right;
+      y->red = e->red;
+      replace_child (t, e->parent, e, y);
+      if (y->left != NULL)
+        y->left->parent = y;
+      if (y->right != NULL)
+        y->right->parent = y;
+    }
+
+  if (!y_red)
+    remove_fixup (t, x, x_parent);
+  t->elem_cnt--;
+}
+
+/* Returns the first element in tree T that is not less than E,
+   or a null pointer if there is none. */
+struct rb_elem *
+rb_lower_bound (struct rb_tree *t, const struct rb_elem *e)
+{
+  struct rb_elem *n = t->root;
+  struct rb_elem *bound = NULL;
+
+  while (n != NULL)
+    if (!t->less (n, e, t->aux))
+      {
+        bound = n;
+        n = n->left;
+      }
+    else
+      n = n->right;
+  return bound;
+}
+
+/* Returns the first element in tree T that is greater than E,
+   or a null pointer if there is none. */
+struct rb_elem *
+rb_upper_bound (struct rb_tree *t, const struct rb_elem *e)
+{
+  struct rb_elem *n = t->root;
+  struct rb_elem *bound = NULL;
+
+  while (n != NULL)
+    if (t->less (e, n, t->aux))
+      {
+        bound = n;
+        n = n->left;
+      }
+    else
+      n = n->right;
+  return bound;
+}
+
+/* Returns the least element in tree T, or rb_end(T) if T is
+   empty. */
+struct rb_elem *
+rb_begin (struct rb_tree *t)
+{
+  ASSERT (t != NULL);
+  return t->root != NULL ? leftmost (t->root) : NULL;
+}
+
+/* Returns the element after E in its tree, or the tree's
+   rb_end() if E is the greatest element. */
+struct rb_elem *
+rb_next (struct rb_elem *e)
+{
+  ASSERT (e != NULL);
+
+  if (e->right != NULL)
+    return leftmost (e->right);
+  while (e->parent != NULL && e == e->parent->right)
+    e = e->parent;
+  return e->parent;
+}
+
+/* Returns the end sentinel for iterating over tree T in
+   ascending order, which is a null pointer. */
+struct rb_elem *
+rb_end (struct rb_tree *t UNUSED)
+{
+  return NULL;
+}
+
+/* Returns the greatest element in tree T, or rb_rend(T) if T is
+   empty. */
+struct rb_elem *
+rb_rbegin (struct rb_tree *t)
+{
+  ASSERT (t != NULL);
+  return t->root != NULL ? rightmost (t->root) : NULL;
+}
+
+/* Returns the element before E in its tree, or the tree's
+   rb_rend() if E is the least element. */
+struct rb_elem *
+rb_prev (struct rb_elem *e)
+{
+  ASSERT (e != NULL);
+
+  if (e->left != NULL)
+    return rightmost (e->left);
+  while (e->parent != NULL && e == e->parent->left)
+    e = e->parent;
+  return e->parent;
+}
+
+/* Returns the end sentinel for iterating over tree T in
+   descending order, which is a null pointer. */
+struct rb_elem *
+rb_rend (struct rb_tree *t UNUSED)
+{
+  return NULL;
+}
+
+/* Returns the number of elements in T. */
+size_t
+rb_size (struct rb_tree *t)
+{
+  ASSERT (t != NULL);
+  return t->elem_cnt;
+}
+
+/* Returns true if T contains no elements, false otherwise. */
+bool
+rb_empty (struct rb_tree *t)
+{
+  ASSERT (t != NULL);
+  return t->elem_cnt == 0;
+}
+
+/* Rotates X down to the left, making its right child Y take its
+   place and X become Y's left child:
+
+        X                 Y
+       / \               / \
+      a   Y     ==>     X   c
+         / \           / \
+        b   c         a   b
+*/
+static void
+rotate_left (struct rb_tree *t, struct rb_elem *x)
+{
+  struct rb_elem *y = x->right;
+
+  x->right = y->left;
+  if (y->left != NULL)
+    y->left->parent = x;
+  y->parent = x->parent;
+  replace_child (t, x->parent, x, y);
+  y->left = x;
+  x->parent = y;
+}
+
+/* Rotates X down to the right, the mirror image of
+   rotate_left(). */
+static void
+rotate_right (struct rb_tree *t, struct rb_elem *x)
+{
+  struct rb_elem *y = x->left;
+
+  x->left = y->right;
+  if (y->right != NULL)
+    y->right->parent = x;
+  y->parent = x->parent;
+  replace_child (t, x->parent, x, y);
+  y->right = x;
+  x->parent = y;
+}
+
+/* Restores the red-black rules after red node X has been
+   inserted into T as a leaf. */
+static void
+insert_fixup (struct rb_tree *t, struct rb_elem *x)
+{
+  struct rb_elem *p;
+
+  while ((p = x->parent) != NULL && p->red)
+    {
+      /* P is red, so it is not the root and has a parent. */
+      struct rb_elem *g = p->parent;
+
+      if (p == g->left)
+        {
+          struct rb_elem *uncle = g->right;
+
+          if (is_red (uncle))
+            {
+              /* Push G's blackness down and continue from G. */
+              p->red = uncle->red = false;
+              g->red = true;
+              x = g;
+              continue;
+            }
+          if (x == p->right)
+            {
+              rotate_left (t, p);
+              x = p;
+              p = x->parent;
+            }
+          p->red = false;
+          g->red = true;
+          rotate_right (t, g);
+        }
+      else
+        {
+          struct rb_elem *uncle = g->left;
+
+          if (is_red (uncle))
+            {
+              p->red = uncle->red = false;
+              g->red = true;
+              x = g;
+              continue;
+            }
+          if (x == p->left)
+            {
+              rotate_right (t, p);
+              x = p;
+              p = x->parent;
+            }
+          p->red = false;
+          g->red = true;
+          rotate_left (t, g);
+        }
+    }
+  t->root->red = false;
+}
+
+/* Restores the red-black rules after a black node has been
+   unlinked from T, leaving X, which may be null, one black node
+   short on every path through it.  PARENT is X's parent. */
+static void
+remove_fixup (struct rb_tree *t, struct rb_elem *x, struct rb_elem *parent)
+{
+  while (x != t->root && !is_red (x))
+    {
+      /* X is short a black node, so its sibling W has at least
+         one black node on every path and cannot be null. */
+      if (x == parent->left)
+        {
+          struct rb_elem *w = parent->right;
+
+          if (w->red)
+            {
+              w->red = false;
+              parent->red = true;
+              rotate_left (t, parent);
+              w = parent->right;
+            }
+          if (!is_red (w->left) && !is_red (w->right))
+            {
+              /* Move the shortage up to PARENT. */
+              w->red = true;
+              x = parent;
+              parent = x->parent;
+              continue;
+            }
+          if (!is_red (w->right))
+            {
+              w->left->red = false;
+              w->red = true;
+              rotate_right (t, w);
+              w = parent->right;
+            }
+          w->red = parent->red;
+          parent->red = false;
+          w->right->red = false;
+          rotate_left (t, parent);
+        }
+      else
+        {
+          struct rb_elem *w = parent->left;
+
+          if (w->red)
+            {
+              w->red = false;
+              parent->red = true;
+              rotate_right (t, parent);
+              w = parent->left;
+            }
+          if (!is_red (w->left) && !is_red (w->right))
+            {
+              w->red = true;
+              x = parent;
+              parent = x->parent;
+              continue;
+            }
+          if (!is_red (w->left))
+            {
+              w->right->red = false;
+              w->red = true;
+              rotate_left (t, w);
+              w = parent->left;
+            }
+          w->red = parent->red;
+          parent->red = false;
+          w->left->red = false;
+          rotate_right (t, parent);
+        }
+      x = t->root;
+    }
+  if (x != NULL)
+    x->red = false;
+}
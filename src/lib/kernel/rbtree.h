@@ -0,0 +1,107 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Red-black tree.
+
+   A balanced binary search tree that keeps its elements in
+   sorted order.  Insertion, deletion, and lookup take O(lg n)
+   time, as do finding the first element not less than a key
+   (rb_lower_bound()) or greater than it (rb_upper_bound()), which
+   a hash table cannot do at all.  That makes it the container of
+   choice for indexes searched by range, such as memory regions
+   by address or extents and requests by sector.
+
+   Like lists and hash tables, trees do not use dynamic
+   allocation.  Instead, each structure that can potentially be
+   in a tree must embed a struct rb_elem member, and the rb_entry
+   macro converts a struct rb_elem back to the structure object
+   that contains it.  Refer to lib/kernel/list.h for a detailed
+   explanation of the technique.
+
+   The tree is ordered by a caller-supplied "less" function.  As
+   with hash tables, lookups take a struct rb_elem too: embed one
+   in a scratch structure, fill in just the key, and pass that.
+   No two elements in a tree may compare equal; rb_insert()
+   refuses a duplicate and returns the element already there.
+
+   Iteration visits elements in ascending order:
+
+      struct rb_elem *e;
+
+      for (e = rb_begin (&foo_tree); e != rb_end (&foo_tree);
+           e = rb_next (e))
+        {
+          struct foo *f = rb_entry (e, struct foo, elem);
+          ...do something with f...
+        }
+
+   or in descending order with rb_rbegin(), rb_prev(), and
+   rb_rend().  Removing the element an iteration is on
+   invalidates it, so fetch the next element first.  An
+   iteration may begin anywhere, e.g. at rb_lower_bound() to
+   visit every element in a range. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Tree element. */
+struct rb_elem
+  {
+    struct rb_elem *parent;     /* Parent, or null for the root. */
+    struct rb_elem *left;       /* Left child, all less than this. */
+    struct rb_elem *right;      /* Right child, all greater. */
+    bool red;                   /* Red node?  (Otherwise black.) */
+  };
+
+/* Converts pointer to tree element RB_ELEM into a pointer to
+   the structure that RB_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the tree element.  See the big comment at the top of the
+   file for an example. */
+#define rb_entry(RB_ELEM, STRUCT, MEMBER)                       \
+        ((STRUCT *) ((uint8_t *) &(RB_ELEM)->parent             \
+                     - offsetof (STRUCT, MEMBER.parent)))
+
+/* Compares the value of two tree elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool rb_less_func (const struct rb_elem *a,
+                           const struct rb_elem *b,
+                           void *aux);
+
+/* Tree. */
+struct rb_tree
+  {
+    struct rb_elem *root;       /* Root, or null if empty. */
+    size_t elem_cnt;            /* Number of elements. */
+    rb_less_func *less;         /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `less'. */
+  };
+
+void rb_init (struct rb_tree *, rb_less_func *, void *aux);
+
+/* Search, insertion, deletion. */
+struct rb_elem *rb_insert (struct rb_tree *, struct rb_elem *);
+struct rb_elem *rb_find (struct rb_tree *, const struct rb_elem *);
+struct rb_elem *rb_delete (struct rb_tree *, const struct rb_elem *);
+void rb_remove (struct rb_tree *, struct rb_elem *);
+
+/* Ordered search. */
+struct rb_elem *rb_lower_bound (struct rb_tree *, const struct rb_elem *);
+struct rb_elem *rb_upper_bound (struct rb_tree *, const struct rb_elem *);
+
+/* Iteration. */
+struct rb_elem *rb_begin (struct rb_tree *);
+struct rb_elem *rb_next (struct rb_elem *);
+struct rb_elem *rb_end (struct rb_tree *);
+
+struct rb_elem *rb_rbegin (struct rb_tree *);
+struct rb_elem *rb_prev (struct rb_elem *);
+struct rb_elem *rb_rend (struct rb_tree *);
+
+/* Information. */
+size_t rb_size (struct rb_tree *);
+bool rb_empty (struct rb_tree *);
+
+#endif /* lib/kernel/rbtree.h */
@@ -0,0 +1,48 @@
+#ifndef __LIB_MEMSTAT_H
+#define __LIB_MEMSTAT_H
+
+#include <stddef.h>
+
+/* Memory statistics, as reported by the memstat system call.
+   Shared between the kernel and user programs. */
+
+/* Page faults, counted by cause.  Every fault is counted once
+   in NOT_PRESENT or RIGHTS and once in USER or KERNEL. */
+struct fault_stats
+  {
+    long long not_present;      /* Access to a not-present page. */
+    long long rights;           /* Access rights violation. */
+    long long user;             /* Raised by user code. */
+    long long kernel;           /* Raised by the kernel. */
+  };
+
+/* Statistics for a single process. */
+struct proc_memstat
+  {
+    struct fault_stats faults;  /* Faults taken by this process. */
+    size_t resident_pages;      /* User pages currently in frames. */
+    size_t peak_resident;       /* Maximum of RESIDENT_PAGES. */
+    size_t pt_pages;            /* Page tables in its page directory. */
+    size_t segment_cnt;         /* ELF segments loaded. */
+    size_t segment_pages;       /* Pages read from ELF segments. */
+  };
+
+/* System-wide statistics. */
+struct sys_memstat
+  {
+    struct fault_stats faults;  /* Faults taken by all threads. */
+    size_t user_pool_size;      /* Pages in the user pool. */
+    size_t user_pool_used;      /* User pages in use, incl. borrowed. */
+    size_t user_pool_peak;      /* Maximum of USER_POOL_USED. */
+    size_t pt_pages;            /* Page tables ever allocated. */
+    size_t segment_pages;       /* Pages ever read from ELF segments. */
+  };
+
+/* Everything the memstat system call reports. */
+struct memstat
+  {
+    struct proc_memstat proc;   /* The calling process. */
+    struct sys_memstat sys;     /* The whole system. */
+  };
+
+#endif /* lib/memstat.h */
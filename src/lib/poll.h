@@ -0,0 +1,26 @@
+#ifndef __LIB_POLL_H
+#define __LIB_POLL_H
+
+/* Readiness polling, as done by the poll system call.
+   Shared between the kernel and user programs. */
+
+/* An fd to poll and the events of interest. */
+struct pollfd
+  {
+    int fd;                     /* File descriptor; ignored if negative. */
+    short events;               /* Events to wait for. */
+    short revents;              /* Events that occurred. */
+  };
+
+/* Events.  POLLERR, POLLHUP and POLLNVAL are always reported and
+   need not be requested. */
+#define POLLIN   0x001          /* Data can be read without waiting. */
+#define POLLOUT  0x004          /* Data can be written without waiting. */
+#define POLLERR  0x008          /* Writing would fail: no readers. */
+#define POLLHUP  0x010          /* No writers: reads reach end of file. */
+#define POLLNVAL 0x020          /* Not an open fd. */
+
+/* Maximum number of fds in one call to poll. */
+#define POLL_MAX 64
+
+#endif /* lib/poll.h */
@@ -13,7 +13,7 @@ struct vsnprintf_aux
     int max_length;     /* Max length of output string. */
   };
 
-static void vsnprintf_helper (char, void *);
+static void vsnprintf_helper (const char *, size_t, void *);
 
 /* Like vprintf(), except that output is stored into BUFFER,
    which must have space for BUF_SIZE characters.  Writes at most
@@ -43,12 +43,19 @@ vsnprintf (char *buffer, size_t buf_size, const char *format, va_list args)
 
 /* Helper function for vsnprintf(). */
 static void
-vsnprintf_helper (char ch, void *aux_)
+vsnprintf_helper (const char *s, size_t n, void *aux_)
 {
   struct vsnprintf_aux *aux = aux_;
 
-  if (aux->length++ < aux->max_length)
-    *aux->p++ = ch;
+  if (aux->length < aux->max_length)
+    {
+      size_t room = aux->max_length - aux->length;
+      size_t copy = n < room ? n : room;
+
+      memcpy (aux->p, s, copy);
+      aux->p += copy;
+    }
+  aux->length += n;
 }
 
 /* Like printf(), except that output is stored into BUFFER,
@@ -146,25 +153,37 @@ static const char *parse_conversion (const char *format,
 static void format_integer (uintmax_t value, bool is_signed, bool negative, 
                             const struct integer_base *,
                             const struct printf_conversion *,
-                            void (*output) (char, void *), void *aux);
+                            void (*output) (const char *, size_t, void *),
+                            void *aux);
 static void output_dup (char ch, size_t cnt,
-                        void (*output) (char, void *), void *aux);
+                        void (*output) (const char *, size_t, void *),
+                        void *aux);
 static void format_string (const char *string, int length,
                            struct printf_conversion *,
-                           void (*output) (char, void *), void *aux);
-
+                           void (*output) (const char *, size_t, void *),
+                           void *aux);
+
+/* Formats FORMAT with ARGS, passing the output to OUTPUT with
+   auxiliary data AUX.  Output is passed along in runs, not a
+   character at a time: each run of literal text, each converted
+   field, and each stretch of padding is one call to OUTPUT, so
+   that OUTPUT can copy or lock once per run. */
 void
 __vprintf (const char *format, va_list args,
-           void (*output) (char, void *), void *aux)
+           void (*output) (const char *, size_t, void *), void *aux)
 {
   for (; *format != '\0'; format++)
     {
       struct printf_conversion c;
 
-      /* Literally copy non-conversions to output. */
+      /* Literally copy runs of non-conversions to output. */
       if (*format != '%') 
         {
-          output (*format, aux);
+          const char *run = format;
+
+          while (format[1] != '\0' && format[1] != '%')
+            format++;
+          output (run, format - run + 1, aux);
           continue;
         }
       format++;
@@ -172,7 +191,7 @@ __vprintf (const char *format, va_list args,
       /* %% => %. */
       if (*format == '%') 
         {
-          output ('%', aux);
+          output ("%", 1, aux);
           continue;
         }
 
@@ -470,9 +489,12 @@ static void
 format_integer (uintmax_t value, bool is_signed, bool negative, 
                 const struct integer_base *b,
                 const struct printf_conversion *c,
-                void (*output) (char, void *), void *aux)
+                void (*output) (const char *, size_t, void *), void *aux)
 {
-  char buf[64], *cp;            /* Buffer and current position. */
+  char buf[64 + 3];             /* Digits, preceded by sign and `0x'. */
+  char *end = buf + sizeof buf; /* End of buffer. */
+  char *cp;                     /* Start of output so far. */
+  char *digits;                 /* Start of digits. */
   int x;                        /* `x' character to use or 0 if none. */
   int sign;                     /* Sign character or 0 if none. */
   int precision;                /* Rendered precision. */
@@ -498,60 +520,77 @@ format_integer (uintmax_t value, bool is_signed, bool negative,
      nonzero value with the # flag. */
   x = (c->flags & POUND) && value ? b->x : 0;
 
-  /* Accumulate digits into buffer.
-     This algorithm produces digits in reverse order, so later we
-     will output the buffer's content in reverse. */
-  cp = buf;
+  /* Accumulate digits into the end of the buffer, least
+     significant first, so that they come out in order. */
+  cp = end;
   digit_cnt = 0;
   while (value > 0) 
     {
       if ((c->flags & GROUP) && digit_cnt > 0 && digit_cnt % b->group == 0)
-        *cp++ = ',';
-      *cp++ = b->digits[value % b->base];
+        *--cp = ',';
+      *--cp = b->digits[value % b->base];
       value /= b->base;
       digit_cnt++;
     }
 
-  /* Append enough zeros to match precision.
+  /* Prepend enough zeros to match precision, leaving room for
+     the prefix below.
      If requested precision is 0, then a value of zero is
      rendered as a null string, otherwise as "0".
      If the # flag is used with base 8, the result must always
      begin with a zero. */
   precision = c->precision < 0 ? 1 : c->precision;
-  while (cp - buf < precision && cp < buf + sizeof buf - 1)
-    *cp++ = '0';
-  if ((c->flags & POUND) && b->base == 8 && (cp == buf || cp[-1] != '0'))
-    *cp++ = '0';
+  while (end - cp < precision && cp > buf + 4)
+    *--cp = '0';
+  if ((c->flags & POUND) && b->base == 8 && (cp == end || *cp != '0'))
+    *--cp = '0';
+  digits = cp;
+
+  /* Prepend sign and `0x', if any. */
+  if (x) 
+    {
+      *--cp = x;
+      *--cp = '0';
+    }
+  if (sign)
+    *--cp = sign;
 
   /* Calculate number of pad characters to fill field width. */
-  pad_cnt = c->width - (cp - buf) - (x ? 2 : 0) - (sign != 0);
+  pad_cnt = c->width - (end - cp);
   if (pad_cnt < 0)
     pad_cnt = 0;
 
-  /* Do output. */
+  /* Do output.  Zero padding goes between the prefix and the
+     digits; otherwise the whole number goes out at once. */
   if ((c->flags & (MINUS | ZERO)) == 0)
     output_dup (' ', pad_cnt, output, aux);
-  if (sign)
-    output (sign, aux);
-  if (x) 
+  if ((c->flags & ZERO) && pad_cnt > 0)
     {
-      output ('0', aux);
-      output (x, aux); 
+      if (digits > cp)
+        output (cp, digits - cp, aux);
+      output_dup ('0', pad_cnt, output, aux);
+      cp = digits;
     }
-  if (c->flags & ZERO)
-    output_dup ('0', pad_cnt, output, aux);
-  while (cp > buf)
-    output (*--cp, aux);
+  if (end > cp)
+    output (cp, end - cp, aux);
   if (c->flags & MINUS)
     output_dup (' ', pad_cnt, output, aux);
 }
 
 /* Writes CH to OUTPUT with auxiliary data AUX, CNT times. */
 static void
-output_dup (char ch, size_t cnt, void (*output) (char, void *), void *aux) 
+output_dup (char ch, size_t cnt,
+            void (*output) (const char *, size_t, void *), void *aux) 
 {
-  while (cnt-- > 0)
-    output (ch, aux);
+  char block[32];
+
+  memset (block, ch, cnt < sizeof block ? cnt : sizeof block);
+  while (cnt > 0)
+    {
+      size_t chunk = cnt < sizeof block ? cnt : sizeof block;
+      output (block, chunk, aux);
+      cnt -= chunk;
+    }
 }
 
 /* Formats the LENGTH characters starting at STRING according to
@@ -560,13 +599,12 @@ output_dup (char ch, size_t cnt, void (*output) (char, void *), void *aux)
 static void
 format_string (const char *string, int length,
                struct printf_conversion *c,
-               void (*output) (char, void *), void *aux) 
+               void (*output) (const char *, size_t, void *), void *aux) 
 {
-  int i;
   if (c->width > length && (c->flags & MINUS) == 0)
     output_dup (' ', c->width - length, output, aux);
-  for (i = 0; i < length; i++)
-    output (string[i], aux);
+  if (length > 0)
+    output (string, length, aux);
   if (c->width > length && (c->flags & MINUS) != 0)
     output_dup (' ', c->width - length, output, aux);
 }
@@ -575,7 +613,7 @@ format_string (const char *string, int length,
    va_list. */
 void
 __printf (const char *format,
-          void (*output) (char, void *), void *aux, ...) 
+          void (*output) (const char *, size_t, void *), void *aux, ...) 
 {
   va_list args;
 
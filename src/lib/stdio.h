@@ -29,9 +29,10 @@ void print_human_readable_size (uint64_t sz);
 
 /* Internal functions. */
 void __vprintf (const char *format, va_list args,
-                void (*output) (char, void *), void *aux);
+                void (*output) (const char *, size_t, void *), void *aux);
 void __printf (const char *format,
-               void (*output) (char, void *), void *aux, ...);
+               void (*output) (const char *, size_t, void *), void *aux,
+               ...);
 
 /* Try to be helpful. */
 #define sprintf dont_use_sprintf_use_snprintf
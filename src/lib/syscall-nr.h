@@ -28,7 +28,18 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_MEMSTAT,                /* Reports memory statistics. */
+    SYS_READV,                  /* Read from a file into several buffers. */
+    SYS_WRITEV,                 /* Write to a file from several buffers. */
+    SYS_PREAD,                  /* Read from a file at a given position. */
+    SYS_PWRITE,                 /* Write to a file at a given position. */
+    SYS_FORK,                   /* Duplicate the current process. */
+    SYS_PIPE,                   /* Create a pipe. */
+    SYS_FCNTL,                  /* Get or set fd flags. */
+    SYS_POLL                    /* Wait for fds to become ready. */
   };
 
 #endif /* lib/syscall-nr.h */
@@ -3,6 +3,67 @@
 #include <syscall.h>
 #include <syscall-nr.h>
 
+/* Standard output buffer.
+
+   Output to STDOUT_FILENO through printf(), putchar(), and the
+   like collects here and goes to the kernel in one write()
+   system call per buffer flush, instead of one per call.  In
+   line-buffered mode, the default, the buffer is also flushed
+   whenever a new-line is written; in fully buffered mode, only
+   when it fills up; and in unbuffered mode it is not used.
+
+   The system call wrappers in syscall.c flush the buffer before
+   any call that could otherwise let output appear out of order
+   or get lost: writes to STDOUT_FILENO, reads from STDIN_FILENO,
+   exec(), fork(), exit(), and halt(). */
+#define STDOUT_BUF_SIZE 512
+static char stdout_buf[STDOUT_BUF_SIZE];
+static size_t stdout_cnt;               /* Bytes in stdout_buf. */
+static int stdout_mode = _IOLBF;        /* Buffering mode. */
+
+static void stdout_put (const char *, size_t);
+
+/* Sets the buffering mode of standard output to MODE, one of
+   _IOFBF (fully buffered), _IOLBF (line buffered), or _IONBF
+   (unbuffered), after flushing any output already buffered. */
+void
+stdout_set_buffering (int mode) 
+{
+  stdout_flush ();
+  stdout_mode = mode;
+}
+
+/* Writes any buffered standard output to STDOUT_FILENO. */
+void
+stdout_flush (void) 
+{
+  size_t cnt = stdout_cnt;
+
+  /* write() flushes too, so empty the buffer first. */
+  stdout_cnt = 0;
+  if (cnt > 0)
+    write (STDOUT_FILENO, stdout_buf, cnt);
+}
+
+/* Adds the N bytes in BUFFER to standard output, according to
+   the buffering mode. */
+static void
+stdout_put (const char *buffer, size_t n) 
+{
+  if (stdout_cnt + n > STDOUT_BUF_SIZE)
+    stdout_flush ();
+  if (stdout_mode == _IONBF || n >= STDOUT_BUF_SIZE)
+    {
+      write (STDOUT_FILENO, buffer, n);
+      return;
+    }
+
+  memcpy (stdout_buf + stdout_cnt, buffer, n);
+  stdout_cnt += n;
+  if (stdout_mode == _IOLBF && memchr (buffer, '\n', n) != NULL)
+    stdout_flush ();
+}
+
 /* The standard vprintf() function,
    which is like printf() but uses a va_list. */
 int
@@ -30,8 +91,8 @@ hprintf (int handle, const char *format, ...)
 int
 puts (const char *s) 
 {
-  write (STDOUT_FILENO, s, strlen (s));
-  putchar ('\n');
+  stdout_put (s, strlen (s));
+  stdout_put ("\n", 1);
 
   return 0;
 }
@@ -41,47 +102,77 @@ int
 putchar (int c) 
 {
   char c2 = c;
-  write (STDOUT_FILENO, &c2, 1);
+  stdout_put (&c2, 1);
   return c;
 }
-
+
 /* Auxiliary data for vhprintf_helper(). */
 struct vhprintf_aux 
   {
-    char buf[64];       /* Character buffer. */
+    char buf[256];      /* Character buffer. */
     char *p;            /* Current position in buffer. */
     int char_cnt;       /* Total characters written so far. */
     int handle;         /* Output file handle. */
   };
 
-static void add_char (char, void *);
+static void add_chars (const char *, size_t, void *);
+static void add_stdout (const char *, size_t, void *);
 static void flush (struct vhprintf_aux *);
 
 /* Formats the printf() format specification FORMAT with
    arguments given in ARGS and writes the output to the given
-   HANDLE. */
+   HANDLE.  Output to STDOUT_FILENO goes through the standard
+   output buffer. */
 int
 vhprintf (int handle, const char *format, va_list args) 
 {
   struct vhprintf_aux aux;
+  int char_cnt;
+
+  if (handle == STDOUT_FILENO)
+    {
+      char_cnt = 0;
+      __vprintf (format, args, add_stdout, &char_cnt);
+      return char_cnt;
+    }
+
   aux.p = aux.buf;
   aux.char_cnt = 0;
   aux.handle = handle;
-  __vprintf (format, args, add_char, &aux);
+  __vprintf (format, args, add_chars, &aux);
   flush (&aux);
   return aux.char_cnt;
 }
 
-/* Adds C to the buffer in AUX, flushing it if the buffer fills
-   up. */
+/* Adds the N characters in S to standard output. */
 static void
-add_char (char c, void *aux_) 
+add_stdout (const char *s, size_t n, void *char_cnt_) 
+{
+  int *char_cnt = char_cnt_;
+  *char_cnt += n;
+  stdout_put (s, n);
+}
+
+/* Adds the N characters in S to the buffer in AUX, flushing it
+   whenever it fills up. */
+static void
+add_chars (const char *s, size_t n, void *aux_) 
 {
   struct vhprintf_aux *aux = aux_;
-  *aux->p++ = c;
-  if (aux->p >= aux->buf + sizeof aux->buf)
-    flush (aux);
-  aux->char_cnt++;
+
+  aux->char_cnt += n;
+  while (n > 0)
+    {
+      size_t room = aux->buf + sizeof aux->buf - aux->p;
+      size_t chunk = n < room ? n : room;
+
+      memcpy (aux->p, s, chunk);
+      aux->p += chunk;
+      s += chunk;
+      n -= chunk;
+      if (aux->p >= aux->buf + sizeof aux->buf)
+        flush (aux);
+    }
 }
 
 /* Flushes the buffer in AUX. */
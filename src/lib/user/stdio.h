@@ -4,4 +4,12 @@
 int hprintf (int, const char *, ...) PRINTF_FORMAT (2, 3);
 int vhprintf (int, const char *, va_list) PRINTF_FORMAT (2, 0);
 
+/* Standard output buffering modes. */
+#define _IOFBF 0                /* Fully buffered. */
+#define _IOLBF 1                /* Line buffered (the default). */
+#define _IONBF 2                /* Unbuffered. */
+
+void stdout_set_buffering (int mode);
+void stdout_flush (void);
+
 #endif /* lib/user/stdio.h */
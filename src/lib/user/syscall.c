@@ -1,4 +1,5 @@
 #include <syscall.h>
+#include <stdio.h>
 #include "../syscall-nr.h"
 
 /* Invokes syscall NUMBER, passing no arguments, and returns the
@@ -61,9 +62,29 @@
           retval;                                               \
         })
 
+/* Invokes syscall NUMBER, passing arguments ARG0, ARG1, ARG2,
+   and ARG3, and returns the return value as an `int'. */
+#define syscall4(NUMBER, ARG0, ARG1, ARG2, ARG3)                \
+        ({                                                      \
+          int retval;                                           \
+          asm volatile                                          \
+            ("pushl %[arg3]; pushl %[arg2]; pushl %[arg1]; "    \
+             "pushl %[arg0]; pushl %[number]; int $0x30; "      \
+             "addl $20, %%esp"                                  \
+               : "=a" (retval)                                  \
+               : [number] "i" (NUMBER),                         \
+                 [arg0] "r" (ARG0),                             \
+                 [arg1] "r" (ARG1),                             \
+                 [arg2] "r" (ARG2),                             \
+                 [arg3] "r" (ARG3)                              \
+               : "memory");                                     \
+          retval;                                               \
+        })
+
 void
 halt (void) 
 {
+  stdout_flush ();
   syscall0 (SYS_HALT);
   NOT_REACHED ();
 }
@@ -71,6 +92,7 @@ halt (void)
 void
 exit (int status)
 {
+  stdout_flush ();
   syscall1 (SYS_EXIT, status);
   NOT_REACHED ();
 }
@@ -78,6 +100,7 @@ exit (int status)
 pid_t
 exec (const char *file)
 {
+  stdout_flush ();
   return (pid_t) syscall1 (SYS_EXEC, file);
 }
 
@@ -114,12 +137,16 @@ filesize (int fd)
 int
 read (int fd, void *buffer, unsigned size)
 {
+  if (fd == STDIN_FILENO)
+    stdout_flush ();
   return syscall3 (SYS_READ, fd, buffer, size);
 }
 
 int
 write (int fd, const void *buffer, unsigned size)
 {
+  if (fd == STDOUT_FILENO)
+    stdout_flush ();
   return syscall3 (SYS_WRITE, fd, buffer, size);
 }
 
@@ -182,3 +209,62 @@ inumber (int fd)
 {
   return syscall1 (SYS_INUMBER, fd);
 }
+
+bool
+memstat (struct memstat *ms)
+{
+  return syscall1 (SYS_MEMSTAT, ms);
+}
+
+int
+readv (int fd, const struct iovec *iov, int iovcnt)
+{
+  if (fd == STDIN_FILENO)
+    stdout_flush ();
+  return syscall3 (SYS_READV, fd, iov, iovcnt);
+}
+
+int
+writev (int fd, const struct iovec *iov, int iovcnt)
+{
+  if (fd == STDOUT_FILENO)
+    stdout_flush ();
+  return syscall3 (SYS_WRITEV, fd, iov, iovcnt);
+}
+
+int
+pread (int fd, void *buffer, unsigned length, unsigned offset)
+{
+  return syscall4 (SYS_PREAD, fd, buffer, length, offset);
+}
+
+int
+pwrite (int fd, const void *buffer, unsigned length, unsigned offset)
+{
+  return syscall4 (SYS_PWRITE, fd, buffer, length, offset);
+}
+
+pid_t
+fork (void)
+{
+  stdout_flush ();
+  return (pid_t) syscall0 (SYS_FORK);
+}
+
+bool
+pipe (int fds[2])
+{
+  return syscall1 (SYS_PIPE, fds);
+}
+
+int
+fcntl (int fd, int cmd, int arg)
+{
+  return syscall3 (SYS_FCNTL, fd, cmd, arg);
+}
+
+int
+poll (struct pollfd *fds, int nfds, int timeout)
+{
+  return syscall3 (SYS_POLL, fds, nfds, timeout);
+}
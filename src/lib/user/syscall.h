@@ -3,6 +3,10 @@
 
 #include <stdbool.h>
 #include <debug.h>
+#include <iovec.h>
+#include <memstat.h>
+#include <poll.h>
+#include <fcntl.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -45,4 +49,15 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Extensions. */
+bool memstat (struct memstat *);
+int readv (int fd, const struct iovec *, int iovcnt);
+int writev (int fd, const struct iovec *, int iovcnt);
+int pread (int fd, void *buffer, unsigned length, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned length, unsigned offset);
+pid_t fork (void);
+bool pipe (int fds[2]);
+int fcntl (int fd, int cmd, int arg);
+int poll (struct pollfd *, int nfds, int timeout);
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,135 @@
+/* Test program and microbenchmark for bitmap_scan() in
+   lib/kernel/bitmap.c.
+
+   Checks bitmap_scan() and bitmap_contains() against a
+   bit-at-a-time reference on random maps, then times allocation
+   from nearly full maps of increasing size, the case that page
+   and sector allocation hit once memory or disk fills up.  With
+   a scanner that skips whole elements, the time per scan should
+   grow far more slowly than the map.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <bitmap.h>
+#include <debug.h>
+#include <random.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/test.h"
+
+/* Largest map that we will test, in bits. */
+#define MAX_BITS 4096
+
+/* Largest map that we will time, in bits. */
+#define MAX_BENCH_BITS (1024 * 1024)
+
+/* Scans per timed map size. */
+#define BENCH_SCANS 1000
+
+static void verify_scan (struct bitmap *, size_t start, size_t cnt,
+                         bool value);
+static void bench_scan (size_t bit_cnt);
+
+/* Test and time bitmap_scan(). */
+void
+test (void)
+{
+  size_t bit_cnt;
+
+  printf ("testing various size bitmaps:");
+  for (bit_cnt = 1; bit_cnt <= MAX_BITS; bit_cnt = bit_cnt * 3 / 2 + 1)
+    {
+      struct bitmap *b = bitmap_create (bit_cnt);
+      int repeat;
+
+      ASSERT (b != NULL);
+      printf (" %zu", bit_cnt);
+      for (repeat = 0; repeat < 10; repeat++)
+        {
+          /* Mostly-set maps make for short runs of clear bits,
+             mostly-clear maps for short runs of set bits. */
+          unsigned density = random_ulong () % 8 + 1;
+          size_t i;
+
+          for (i = 0; i < bit_cnt; i++)
+            bitmap_set (b, i, random_ulong () % 9 < density);
+          for (i = 0; i < 64; i++)
+            {
+              size_t start = random_ulong () % (bit_cnt + 1);
+              size_t cnt = random_ulong () % 16;
+
+              verify_scan (b, start, cnt, false);
+              verify_scan (b, start, cnt, true);
+            }
+        }
+      bitmap_destroy (b);
+    }
+  printf (" done\n");
+
+  printf ("timing scans of nearly full bitmaps:\n");
+  for (bit_cnt = 1024; bit_cnt <= MAX_BENCH_BITS; bit_cnt *= 4)
+    bench_scan (bit_cnt);
+  printf ("bitmap: PASS\n");
+}
+
+/* Returns the first group of CNT bits at or after START in B that
+   are all VALUE, found one bit at a time. */
+static size_t
+reference_scan (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+  size_t i, j;
+
+  for (i = start; i + cnt <= bitmap_size (b); i++)
+    {
+      for (j = 0; j < cnt; j++)
+        if (bitmap_test (b, i + j) != value)
+          break;
+      if (j == cnt)
+        return i;
+    }
+  return BITMAP_ERROR;
+}
+
+/* Checks bitmap_scan() and bitmap_contains() on B against the
+   reference. */
+static void
+verify_scan (struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+  size_t expected = reference_scan (b, start, cnt, value);
+  size_t end = start + cnt <= bitmap_size (b) ? start + cnt : bitmap_size (b);
+
+  ASSERT (bitmap_scan (b, start, cnt, value) == expected);
+  ASSERT (bitmap_contains (b, start, end - start, !value)
+          == (reference_scan (b, start, end - start, value) != start));
+}
+
+/* Times bitmap_scan_and_flip() on a map of BIT_CNT bits that is
+   full except for one free bit in each of BENCH_SCANS evenly
+   spaced places near its end, and prints the result. */
+static void
+bench_scan (size_t bit_cnt)
+{
+  struct bitmap *b = bitmap_create (bit_cnt);
+  size_t spacing = bit_cnt / 4 / BENCH_SCANS;
+  int64_t start;
+  size_t i;
+
+  ASSERT (b != NULL);
+  bitmap_set_all (b, true);
+  if (spacing == 0)
+    spacing = 1;
+  for (i = 0; i < BENCH_SCANS; i++)
+    bitmap_reset (b, bit_cnt - 1 - i * spacing);
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_SCANS; i++)
+    ASSERT (bitmap_scan_and_flip (b, 0, 1, false) != BITMAP_ERROR);
+  printf ("  %7zu bits: %d scans in %lld ticks\n",
+          bit_cnt, BENCH_SCANS, timer_elapsed (start));
+  ASSERT (bitmap_scan (b, 0, 1, false) == BITMAP_ERROR);
+
+  bitmap_destroy (b);
+}
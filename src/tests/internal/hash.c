@@ -0,0 +1,189 @@
+/* Test program and benchmark for lib/kernel/hash.c.
+
+   Runs the same workloads against a chained table (hash_init())
+   and an open-addressing table (hash_init_open()), checking that
+   both behave the same and timing each.  The workloads mimic the
+   kernel's lookups: inodes keyed by sector number, supplemental
+   page table entries keyed by user page address, and directory
+   entries keyed by name.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <hash.h>
+#include <random.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/test.h"
+
+/* Number of elements in each workload. */
+#define ELEM_CNT 4096
+
+/* Number of times each workload's lookups are repeated. */
+#define LOOKUP_ROUNDS 64
+
+/* A hash table element. */
+struct item
+  {
+    struct hash_elem elem;      /* Hash element. */
+    unsigned key;               /* Key for numeric workloads. */
+    char name[16];              /* Key for the name workload. */
+  };
+
+static struct item items[ELEM_CNT];
+
+static unsigned item_hash (const struct hash_elem *, void *);
+static bool item_less (const struct hash_elem *, const struct hash_elem *,
+                       void *);
+static unsigned name_hash (const struct hash_elem *, void *);
+static bool name_less (const struct hash_elem *, const struct hash_elem *,
+                       void *);
+static void run (const char *workload, hash_hash_func *, hash_less_func *);
+
+/* Test and time both kinds of hash table. */
+void
+test (void)
+{
+  size_t i;
+
+  /* Inodes: scattered sector numbers. */
+  for (i = 0; i < ELEM_CNT; i++)
+    items[i].key = random_ulong () % (8 * 1024 * 1024);
+  run ("inode", item_hash, item_less);
+
+  /* Page table: runs of consecutive pages for code, data, heap,
+     and stack. */
+  for (i = 0; i < ELEM_CNT; i++)
+    items[i].key = ((i % 4) * 0x10000000 + 0x08048000) + (i / 4) * 4096;
+  run ("page table", item_hash, item_less);
+
+  /* Directory entries: short file names. */
+  for (i = 0; i < ELEM_CNT; i++)
+    snprintf (items[i].name, sizeof items[i].name, "file%zu.%c",
+              i, (char) ('a' + i % 26));
+  run ("dentry", name_hash, name_less);
+
+  printf ("hash: PASS\n");
+}
+
+/* Returns the number of elements found by iterating over H. */
+static size_t
+count_elems (struct hash *h)
+{
+  struct hash_iterator i;
+  size_t cnt = 0;
+
+  hash_first (&i, h);
+  while (hash_next (&i))
+    cnt++;
+  return cnt;
+}
+
+/* Runs one workload against table H, which must be empty, and
+   returns the number of timer ticks it took.  Numeric keys may
+   repeat, so duplicates are expected and checked for. */
+static int64_t
+exercise (struct hash *h)
+{
+  int64_t start = timer_ticks ();
+  size_t inserted = 0;
+  size_t i;
+  int round;
+
+  /* Insert. */
+  for (i = 0; i < ELEM_CNT; i++)
+    {
+      struct hash_elem *old = hash_insert (h, &items[i].elem);
+      if (old == NULL)
+        inserted++;
+      else
+        ASSERT (hash_find (h, &items[i].elem) == old);
+    }
+  ASSERT (hash_size (h) == inserted);
+  ASSERT (count_elems (h) == inserted);
+
+  /* Look up every element, many times. */
+  for (round = 0; round < LOOKUP_ROUNDS; round++)
+    for (i = 0; i < ELEM_CNT; i++)
+      ASSERT (hash_find (h, &items[i].elem) != NULL);
+
+  /* Delete every other element, then make sure exactly the right
+     ones are gone. */
+  for (i = 0; i < ELEM_CNT; i += 2)
+    hash_delete (h, &items[i].elem);
+  for (i = 0; i < ELEM_CNT; i++)
+    {
+      struct hash_elem *found = hash_find (h, &items[i].elem);
+      if (found != NULL)
+        {
+          ASSERT (hash_delete (h, found) == found);
+        }
+    }
+  ASSERT (hash_empty (h));
+  ASSERT (count_elems (h) == 0);
+
+  /* Replace on an empty table behaves like insert. */
+  for (i = 0; i < ELEM_CNT; i++)
+    hash_replace (h, &items[i].elem);
+  ASSERT (hash_size (h) == inserted);
+  hash_clear (h, NULL);
+  ASSERT (hash_empty (h));
+
+  return timer_elapsed (start);
+}
+
+/* Runs WORKLOAD with HASH and LESS on both kinds of table and
+   prints the times. */
+static void
+run (const char *workload, hash_hash_func *hash, hash_less_func *less)
+{
+  struct hash h;
+  int64_t chained, open;
+
+  ASSERT (hash_init (&h, hash, less, NULL));
+  chained = exercise (&h);
+  hash_destroy (&h, NULL);
+
+  ASSERT (hash_init_open (&h, hash, less, NULL));
+  open = exercise (&h);
+  hash_destroy (&h, NULL);
+
+  printf ("%s: chained %lld ticks, open addressing %lld ticks\n",
+          workload, chained, open);
+}
+
+/* Returns a hash of the key in the item that contains E. */
+static unsigned
+item_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_int (hash_entry (e, struct item, elem)->key);
+}
+
+/* Returns true if the key in A's item is less than B's. */
+static bool
+item_less (const struct hash_elem *a, const struct hash_elem *b,
+           void *aux UNUSED)
+{
+  return (hash_entry (a, struct item, elem)->key
+          < hash_entry (b, struct item, elem)->key);
+}
+
+/* Returns a hash of the name in the item that contains E. */
+static unsigned
+name_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_string (hash_entry (e, struct item, elem)->name);
+}
+
+/* Returns true if the name in A's item is less than B's. */
+static bool
+name_less (const struct hash_elem *a, const struct hash_elem *b,
+           void *aux UNUSED)
+{
+  return strcmp (hash_entry (a, struct item, elem)->name,
+                 hash_entry (b, struct item, elem)->name) < 0;
+}
@@ -0,0 +1,182 @@
+/* Test program for lib/kernel/heap.c.
+
+   Pushes, pops, removes and decreases elements of heaps of
+   various sizes in random order, checking after every operation
+   that the heap is well formed and that its minimum matches a
+   brute-force search over the elements that should be in it.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <heap.h>
+#include <limits.h>
+#include <random.h>
+#include <stdio.h>
+#include "threads/test.h"
+
+/* Maximum number of elements in a heap that we will test. */
+#define MAX_SIZE 256
+
+/* A heap element. */
+struct value
+  {
+    struct heap_elem elem;      /* Heap element. */
+    int value;                  /* Item value. */
+    bool in_heap;               /* In the heap? */
+  };
+
+static bool value_less (const struct heap_elem *, const struct heap_elem *,
+                        void *);
+static void verify_heap (struct heap *, struct value[], size_t);
+
+/* Test the heap implementation. */
+void
+test (void)
+{
+  size_t size;
+
+  printf ("testing various size heaps:");
+  for (size = 1; size <= MAX_SIZE; size = size * 2 + 1)
+    {
+      static struct value values[MAX_SIZE];
+      struct heap h;
+      size_t i;
+      int prev;
+
+      printf (" %zu", size);
+      heap_init (&h, value_less, NULL);
+      for (i = 0; i < size; i++)
+        {
+          values[i].value = random_ulong () % (size * 2);
+          values[i].in_heap = true;
+          heap_push (&h, &values[i].elem);
+          verify_heap (&h, values, size);
+        }
+
+      /* Randomly remove, decrease and reinsert. */
+      for (i = 0; i < size * 8; i++)
+        {
+          struct value *v = &values[random_ulong () % size];
+
+          switch (random_ulong () % 3)
+            {
+            case 0:
+              if (v->in_heap)
+                {
+                  heap_remove (&h, &v->elem);
+                  v->in_heap = false;
+                }
+              else
+                {
+                  v->value = random_ulong () % (size * 2);
+                  heap_push (&h, &v->elem);
+                  v->in_heap = true;
+                }
+              break;
+
+            case 1:
+              if (v->in_heap)
+                {
+                  v->value -= random_ulong () % (size + 1);
+                  heap_decrease (&h, &v->elem);
+                }
+              break;
+
+            case 2:
+              if (!heap_empty (&h))
+                {
+                  struct heap_elem *e = heap_pop_min (&h);
+                  heap_entry (e, struct value, elem)->in_heap = false;
+                }
+              break;
+            }
+          verify_heap (&h, values, size);
+        }
+
+      /* Drain the heap, checking that it comes out in order. */
+      prev = INT_MIN;
+      while (!heap_empty (&h))
+        {
+          struct value *v = heap_entry (heap_pop_min (&h), struct value, elem);
+          ASSERT (v->in_heap);
+          ASSERT (v->value >= prev);
+          v->in_heap = false;
+          prev = v->value;
+        }
+      verify_heap (&h, values, size);
+    }
+  printf (" done\n");
+  printf ("heap: PASS\n");
+}
+
+/* Returns true if value A is less than value B, false
+   otherwise. */
+static bool
+value_less (const struct heap_elem *a_, const struct heap_elem *b_,
+            void *aux UNUSED)
+{
+  const struct value *a = heap_entry (a_, struct value, elem);
+  const struct value *b = heap_entry (b_, struct value, elem);
+
+  return a->value < b->value;
+}
+
+/* Checks the subtree rooted at E: every element is in the heap
+   and no less than PARENT, and each child's back link is right.
+   Returns the number of elements in the subtree. */
+static size_t
+verify_subtree (struct heap_elem *e, struct heap_elem *parent)
+{
+  size_t cnt = 0;
+
+  for (; e != NULL; e = e->next)
+    {
+      struct value *v = heap_entry (e, struct value, elem);
+
+      ASSERT (v->in_heap);
+      ASSERT (!value_less (e, parent, NULL));
+      if (e->child != NULL)
+        {
+          ASSERT (e->child->prev == e);
+        }
+      if (e->next != NULL)
+        {
+          ASSERT (e->next->prev == e);
+        }
+      cnt += 1 + verify_subtree (e->child, e);
+    }
+  return cnt;
+}
+
+/* Checks that heap H holds exactly the CNT-element array VALUES'
+   members whose in_heap flags are set, and that its minimum is
+   the least of them. */
+static void
+verify_heap (struct heap *h, struct value values[], size_t cnt)
+{
+  struct value *min = NULL;
+  size_t in_cnt = 0;
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    if (values[i].in_heap)
+      {
+        in_cnt++;
+        if (min == NULL || values[i].value < min->value)
+          min = &values[i];
+      }
+
+  ASSERT (heap_size (h) == in_cnt);
+  ASSERT (heap_empty (h) == (in_cnt == 0));
+  if (in_cnt > 0)
+    {
+      struct heap_elem *root = heap_min (h);
+
+      ASSERT (heap_entry (root, struct value, elem)->value == min->value);
+      ASSERT (root->prev == NULL && root->next == NULL);
+      ASSERT (1 + verify_subtree (root->child, root) == in_cnt);
+    }
+}
@@ -0,0 +1,273 @@
+/* Stress test for lib/kernel/rbtree.c.
+
+   Inserts and deletes random keys in trees of various sizes,
+   checking after every operation that the red-black rules hold,
+   and compares lookups, rb_lower_bound(), rb_upper_bound(), and
+   iteration in both directions against a flag array that records
+   which keys should be present.  Then inserts keys in ascending
+   and descending order, the worst case for an unbalanced tree,
+   and checks that the height stays logarithmic.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <random.h>
+#include <rbtree.h>
+#include <stdio.h>
+#include "threads/test.h"
+
+/* Maximum number of distinct keys that we will test. */
+#define MAX_KEYS 512
+
+/* Number of elements inserted in order. */
+#define ORDERED_CNT 4096
+
+/* A tree element. */
+struct value
+  {
+    struct rb_elem elem;        /* Tree element. */
+    int key;                    /* Key. */
+  };
+
+static bool value_less (const struct rb_elem *, const struct rb_elem *,
+                        void *);
+static int verify_tree (struct rb_tree *);
+static void verify_contents (struct rb_tree *, const bool present[],
+                             int key_cnt);
+static void test_ordered (bool ascending);
+
+/* Test the red-black tree implementation. */
+void
+test (void)
+{
+  static struct value values[MAX_KEYS];
+  static bool present[MAX_KEYS];
+  int key_cnt;
+
+  printf ("testing various size trees:");
+  for (key_cnt = 1; key_cnt <= MAX_KEYS; key_cnt *= 2)
+    {
+      struct rb_tree t;
+      int i;
+
+      printf (" %d", key_cnt);
+      rb_init (&t, value_less, NULL);
+      for (i = 0; i < key_cnt; i++)
+        {
+          values[i].key = i;
+          present[i] = false;
+        }
+
+      /* Insert and delete at random, favoring inserts for the
+         first half of the run and deletes for the second, so
+         that the tree fills up and then empties out. */
+      for (i = 0; i < key_cnt * 16; i++)
+        {
+          int key = random_ulong () % key_cnt;
+          bool insert = (int) (random_ulong () % 4) < (i < key_cnt * 8 ? 3 : 1);
+          struct value probe;
+
+          probe.key = key;
+          if (insert)
+            {
+              struct rb_elem *old = rb_insert (&t, &values[key].elem);
+              ASSERT ((old != NULL) == present[key]);
+              ASSERT (old == NULL || old == &values[key].elem);
+              present[key] = true;
+            }
+          else
+            {
+              struct rb_elem *old = rb_delete (&t, &probe.elem);
+              ASSERT ((old != NULL) == present[key]);
+              ASSERT (old == NULL || old == &values[key].elem);
+              present[key] = false;
+            }
+          verify_tree (&t);
+          if (i % 8 == 0)
+            verify_contents (&t, present, key_cnt);
+        }
+
+      /* Empty the tree by removing elements directly. */
+      while (!rb_empty (&t))
+        {
+          struct rb_elem *e = random_ulong () % 2 ? rb_begin (&t) : t.root;
+          present[rb_entry (e, struct value, elem)->key] = false;
+          rb_remove (&t, e);
+          verify_tree (&t);
+        }
+      verify_contents (&t, present, key_cnt);
+    }
+  printf (" done\n");
+
+  printf ("testing ordered insertion:");
+  test_ordered (true);
+  test_ordered (false);
+  printf (" done\n");
+  printf ("rbtree: PASS\n");
+}
+
+/* Returns true if value A's key is less than value B's, false
+   otherwise. */
+static bool
+value_less (const struct rb_elem *a_, const struct rb_elem *b_,
+            void *aux UNUSED)
+{
+  const struct value *a = rb_entry (a_, struct value, elem);
+  const struct value *b = rb_entry (b_, struct value, elem);
+
+  return a->key < b->key;
+}
+
+/* Checks the subtree rooted at E, whose parent should be PARENT,
+   for correct parent links, key order, and the red-black rules.
+   Returns the subtree's black height and stores its number of
+   elements in *CNT and its height in *HEIGHT. */
+static int
+verify_subtree (struct rb_elem *e, struct rb_elem *parent,
+                size_t *cnt, int *height)
+{
+  size_t left_cnt, right_cnt;
+  int left_height, right_height;
+  int left_black, right_black;
+
+  if (e == NULL)
+    {
+      *cnt = 0;
+      *height = 0;
+      return 1;
+    }
+
+  ASSERT (e->parent == parent);
+  if (e->red)
+    {
+      ASSERT (!(e->left != NULL && e->left->red)
+              && !(e->right != NULL && e->right->red));
+    }
+  if (e->left != NULL)
+    {
+      ASSERT (value_less (e->left, e, NULL));
+    }
+  if (e->right != NULL)
+    {
+      ASSERT (value_less (e, e->right, NULL));
+    }
+
+  left_black = verify_subtree (e->left, e, &left_cnt, &left_height);
+  right_black = verify_subtree (e->right, e, &right_cnt, &right_height);
+  ASSERT (left_black == right_black);
+
+  *cnt = left_cnt + right_cnt + 1;
+  *height = (left_height > right_height ? left_height : right_height) + 1;
+  return left_black + !e->red;
+}
+
+/* Checks that tree T is well formed and holds rb_size(T)
+   elements.  Returns its height. */
+static int
+verify_tree (struct rb_tree *t)
+{
+  size_t cnt;
+  int height;
+
+  ASSERT (t->root == NULL || !t->root->red);
+  verify_subtree (t->root, NULL, &cnt, &height);
+  ASSERT (cnt == rb_size (t));
+  ASSERT (rb_empty (t) == (cnt == 0));
+  return height;
+}
+
+/* Checks that tree T holds exactly the keys less than KEY_CNT
+   whose PRESENT flags are set, by lookup, by iteration in both
+   directions, and by rb_lower_bound() and rb_upper_bound(). */
+static void
+verify_contents (struct rb_tree *t, const bool present[], int key_cnt)
+{
+  struct rb_elem *e;
+  struct value probe;
+  int key;
+
+  /* Ascending iteration visits the present keys in order. */
+  key = -1;
+  for (e = rb_begin (t); e != rb_end (t); e = rb_next (e))
+    {
+      int next = rb_entry (e, struct value, elem)->key;
+      for (key++; key < next; key++)
+        ASSERT (!present[key]);
+      ASSERT (present[key]);
+    }
+  for (key++; key < key_cnt; key++)
+    ASSERT (!present[key]);
+
+  /* So does descending iteration, backward. */
+  key = key_cnt;
+  for (e = rb_rbegin (t); e != rb_rend (t); e = rb_prev (e))
+    {
+      int next = rb_entry (e, struct value, elem)->key;
+      for (key--; key > next; key--)
+        ASSERT (!present[key]);
+      ASSERT (present[key]);
+    }
+  for (key--; key >= 0; key--)
+    ASSERT (!present[key]);
+
+  /* Bounds and lookups, including keys off either end. */
+  for (probe.key = -1; probe.key <= key_cnt; probe.key++)
+    {
+      int lower, upper;
+      struct rb_elem *found;
+
+      for (lower = probe.key < 0 ? 0 : probe.key;
+           lower < key_cnt && !present[lower]; lower++)
+        continue;
+      for (upper = probe.key + 1; upper < key_cnt && !present[upper]; upper++)
+        continue;
+
+      e = rb_lower_bound (t, &probe.elem);
+      if (lower < key_cnt)
+        {
+          ASSERT (e != NULL && rb_entry (e, struct value, elem)->key == lower);
+        }
+      else
+        ASSERT (e == NULL);
+
+      e = rb_upper_bound (t, &probe.elem);
+      if (upper < key_cnt)
+        {
+          ASSERT (e != NULL && rb_entry (e, struct value, elem)->key == upper);
+        }
+      else
+        ASSERT (e == NULL);
+
+      found = rb_find (t, &probe.elem);
+      ASSERT ((found != NULL)
+              == (probe.key >= 0 && probe.key < key_cnt && present[probe.key]));
+    }
+}
+
+/* Inserts ORDERED_CNT elements in ascending order if ASCENDING
+   is true, otherwise in descending order, and checks that the
+   tree's height stays within the red-black bound of
+   2 * lg (n + 1). */
+static void
+test_ordered (bool ascending)
+{
+  static struct value values[ORDERED_CNT];
+  struct rb_tree t;
+  int height_limit;
+  int i;
+
+  rb_init (&t, value_less, NULL);
+  for (i = 0; i < ORDERED_CNT; i++)
+    {
+      values[i].key = ascending ? i : ORDERED_CNT - i;
+      ASSERT (rb_insert (&t, &values[i].elem) == NULL);
+    }
+
+  for (height_limit = 0; (1 << height_limit) <= ORDERED_CNT; height_limit++)
+    continue;
+  ASSERT (verify_tree (&t) <= 2 * height_limit);
+  printf (" %s", ascending ? "ascending" : "descending");
+}
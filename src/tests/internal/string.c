@@ -0,0 +1,186 @@
+/* Test program for memcpy(), memmove() and memset() in
+   lib/string.c.
+
+   Checks every combination of source and destination alignment
+   over a range of sizes on both sides of the word and string
+   instruction thresholds, including overlapping moves in both
+   directions, then times page-sized copies and fills.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <random.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/test.h"
+
+/* Largest block that we will test, in bytes. */
+#define MAX_SIZE 300
+
+/* Bytes of guard space on either side of each block. */
+#define GUARD 8
+
+/* Size of each timed block and number of times it is moved. */
+#define BENCH_SIZE 4096
+#define BENCH_REPS 10000
+
+static uint8_t src_buf[MAX_SIZE + 2 * GUARD];
+static uint8_t dst_buf[MAX_SIZE + 2 * GUARD];
+static uint8_t ref_buf[MAX_SIZE + 2 * GUARD];
+
+static void test_copy (size_t dst_ofs, size_t src_ofs, size_t size);
+static void test_set (size_t ofs, size_t size);
+static void test_move (size_t dst_ofs, size_t src_ofs, size_t size);
+static void bench (void);
+
+/* Test the block copy and fill functions. */
+void
+test (void)
+{
+  size_t size;
+
+  random_bytes (src_buf, sizeof src_buf);
+
+  printf ("testing memcpy and memset:");
+  for (size = 0; size <= MAX_SIZE - 2 * GUARD; size++)
+    {
+      size_t dst_ofs, src_ofs;
+
+      if (size % 16 == 0)
+        printf (" %zu", size);
+      for (dst_ofs = 0; dst_ofs < 4; dst_ofs++)
+        {
+          for (src_ofs = 0; src_ofs < 4; src_ofs++)
+            test_copy (dst_ofs, src_ofs, size);
+          test_set (dst_ofs, size);
+        }
+    }
+  printf (" done\n");
+
+  printf ("testing memmove:");
+  for (size = 0; size <= MAX_SIZE / 2; size++)
+    {
+      size_t dst_ofs, src_ofs;
+
+      if (size % 16 == 0)
+        printf (" %zu", size);
+      for (dst_ofs = 0; dst_ofs < 12; dst_ofs++)
+        for (src_ofs = 0; src_ofs < 12; src_ofs++)
+          test_move (dst_ofs, src_ofs, size);
+    }
+  printf (" done\n");
+
+  bench ();
+  printf ("string: PASS\n");
+}
+
+/* Checks that DST_BUF and REF_BUF are identical. */
+static void
+verify (void)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof dst_buf; i++)
+    ASSERT (dst_buf[i] == ref_buf[i]);
+}
+
+/* Fills DST_BUF and REF_BUF with the same random bytes. */
+static void
+scramble (void)
+{
+  random_bytes (dst_buf, sizeof dst_buf);
+  memcpy (ref_buf, dst_buf, sizeof ref_buf);
+  verify ();
+}
+
+/* Copies SIZE bytes from SRC_BUF + SRC_OFS to DST_BUF + DST_OFS
+   with memcpy() and checks the result, including that the bytes
+   around the destination are untouched. */
+static void
+test_copy (size_t dst_ofs, size_t src_ofs, size_t size)
+{
+  uint8_t *src = src_buf + GUARD + src_ofs;
+  size_t i;
+
+  scramble ();
+  for (i = 0; i < size; i++)
+    ref_buf[GUARD + dst_ofs + i] = src[i];
+  ASSERT (memcpy (dst_buf + GUARD + dst_ofs, src, size)
+          == dst_buf + GUARD + dst_ofs);
+  verify ();
+}
+
+/* Fills SIZE bytes at DST_BUF + OFS with memset() and checks the
+   result. */
+static void
+test_set (size_t ofs, size_t size)
+{
+  int value = random_ulong ();
+  size_t i;
+
+  scramble ();
+  for (i = 0; i < size; i++)
+    ref_buf[GUARD + ofs + i] = value;
+  ASSERT (memset (dst_buf + GUARD + ofs, value, size)
+          == dst_buf + GUARD + ofs);
+  verify ();
+}
+
+/* Moves SIZE bytes within DST_BUF from SRC_OFS to DST_OFS with
+   memmove(), which may overlap in either direction, and checks
+   the result. */
+static void
+test_move (size_t dst_ofs, size_t src_ofs, size_t size)
+{
+  uint8_t tmp[MAX_SIZE];
+  size_t i;
+
+  scramble ();
+  for (i = 0; i < size; i++)
+    tmp[i] = ref_buf[GUARD + src_ofs + i];
+  for (i = 0; i < size; i++)
+    ref_buf[GUARD + dst_ofs + i] = tmp[i];
+  ASSERT (memmove (dst_buf + GUARD + dst_ofs, dst_buf + GUARD + src_ofs,
+                   size)
+          == dst_buf + GUARD + dst_ofs);
+  verify ();
+}
+
+/* Times BENCH_REPS copies and fills of BENCH_SIZE bytes, both
+   aligned and misaligned, and prints the results. */
+static void
+bench (void)
+{
+  static uint8_t a[BENCH_SIZE + 4], b[BENCH_SIZE + 4];
+  size_t ofs;
+
+  printf ("timing %d-byte blocks:\n", BENCH_SIZE);
+  for (ofs = 0; ofs < 4; ofs += 3)
+    {
+      int64_t start;
+      int i;
+
+      start = timer_ticks ();
+      for (i = 0; i < BENCH_REPS; i++)
+        memcpy (a + ofs, b, BENCH_SIZE);
+      printf ("  memcpy, offset %zu: %lld ticks\n",
+              ofs, timer_elapsed (start));
+
+      start = timer_ticks ();
+      for (i = 0; i < BENCH_REPS; i++)
+        memmove (a + ofs, a + 1, BENCH_SIZE);
+      printf ("  memmove, offset %zu: %lld ticks\n",
+              ofs, timer_elapsed (start));
+
+      start = timer_ticks ();
+      for (i = 0; i < BENCH_REPS; i++)
+        memset (a + ofs, i, BENCH_SIZE);
+      printf ("  memset, offset %zu: %lld ticks\n",
+              ofs, timer_elapsed (start));
+    }
+}
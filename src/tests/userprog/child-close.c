@@ -1,11 +1,11 @@
 /* Child process run by multi-child-fd test.
 
-   Attempts to close the file descriptor passed as the first
-   command-line argument.  This is invalid, because file
-   descriptors are not inherited in Pintos.  Two results are
-   allowed: either the system call should return without taking
-   any action, or the kernel should terminate the process with a
-   -1 exit code. */
+   Closes the file descriptor passed as the first command-line
+   argument.  The child inherited it from its parent across exec,
+   so this closes only the child's own copy, which must not
+   affect the parent's.  A kernel without fd inheritance may
+   instead return without taking any action or terminate the
+   process with a -1 exit code, which the test also accepts. */
 
 #include <ctype.h>
 #include <stdio.h>
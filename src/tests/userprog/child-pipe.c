@@ -0,0 +1,36 @@
+/* Child process run by pipe-exec test.
+
+   Reads from the pipe read end passed as the first command-line
+   argument until end of file, which comes only if the write end,
+   passed as the second argument, was not inherited. */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-pipe";
+
+int
+main (int argc, char *argv[]) 
+{
+  char buf[64];
+  int rfd, wfd, n;
+
+  msg ("begin");
+  if (argc != 3 || !isdigit (*argv[1]) || !isdigit (*argv[2]))
+    fail ("bad command-line arguments");
+  rfd = atoi (argv[1]);
+  wfd = atoi (argv[2]);
+
+  CHECK (fcntl (wfd, F_GETFD, 0) == -1, "write end not inherited");
+  n = read (rfd, buf, sizeof buf - 1);
+  if (n < 0)
+    fail ("read failed");
+  buf[n] = '\0';
+  msg ("read \"%s\"", buf);
+  CHECK (read (rfd, buf, sizeof buf) == 0, "read returns 0 at end of file");
+  msg ("end");
+
+  return 0;
+}
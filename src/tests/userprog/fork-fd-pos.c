@@ -0,0 +1,41 @@
+/* Reads part of a file, forks, and reads on in the child.  The
+   child must start where the parent left off, and the parent's
+   file position must not move with the child's. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[10];
+  int handle;
+  pid_t pid;
+  int status;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (read (handle, buf, sizeof buf) == sizeof buf,
+         "read %zu bytes", sizeof buf);
+
+  msg ("fork");
+  pid = fork ();
+  if (pid == 0)
+    {
+      /* Child: continue from the parent's position. */
+      if (tell (handle) != sizeof buf)
+        exit (1);
+      if (read (handle, buf, sizeof buf) != sizeof buf
+          || memcmp (buf, sample + sizeof buf, sizeof buf))
+        exit (2);
+      exit (0);
+    }
+  if (pid < 0)
+    fail ("fork returned %d", pid);
+
+  status = wait (pid);
+  CHECK (status == 0, "child read on from the parent's position");
+  CHECK (tell (handle) == sizeof buf, "parent's position unchanged");
+}
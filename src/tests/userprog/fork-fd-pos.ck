@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fork-fd-pos) begin
+(fork-fd-pos) open "sample.txt"
+(fork-fd-pos) read 10 bytes
+(fork-fd-pos) fork
+fork-fd-pos: exit(0)
+(fork-fd-pos) child read on from the parent's position
+(fork-fd-pos) parent's position unchanged
+(fork-fd-pos) end
+fork-fd-pos: exit(0)
+EOF
+pass;
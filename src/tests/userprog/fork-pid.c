@@ -0,0 +1,25 @@
+/* Forks a child that exits right away and checks that fork()
+   returns 0 in the child and the child's pid in the parent,
+   which the parent can then wait for. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t pid;
+  int status;
+
+  msg ("fork");
+  pid = fork ();
+  if (pid == 0)
+    exit (81);
+
+  /* Wait before printing anything, so that the child's exit
+     message comes first. */
+  status = pid > 0 ? wait (pid) : -1;
+  CHECK (pid > 0, "fork returned a pid in the parent");
+  CHECK (status == 81, "wait for the child returned its exit status");
+}
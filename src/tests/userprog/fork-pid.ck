@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fork-pid) begin
+(fork-pid) fork
+fork-pid: exit(81)
+(fork-pid) fork returned a pid in the parent
+(fork-pid) wait for the child returned its exit status
+(fork-pid) end
+fork-pid: exit(0)
+EOF
+pass;
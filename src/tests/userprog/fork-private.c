@@ -0,0 +1,79 @@
+/* Writes to data, BSS, and stack pages, forks, and then has the
+   parent and the child each write to the same pages.  Neither
+   process may see the other's writes.  A pipe makes the child
+   look only after the parent has written. */
+
+#include <stdbool.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+static char data[PAGE_SIZE * 2] = "data";
+static char bss[PAGE_SIZE * 3];
+
+/* Sets one byte in every page of DATA, BSS, and STACK to
+   VALUE. */
+static void
+fill (char *stack, char value)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof data; i += PAGE_SIZE)
+    data[i] = value;
+  for (i = 0; i < sizeof bss; i += PAGE_SIZE)
+    bss[i] = value;
+  *stack = value;
+}
+
+/* Returns true if every byte set by fill() is VALUE. */
+static bool
+check (const char *stack, char value)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof data; i += PAGE_SIZE)
+    if (data[i] != value)
+      return false;
+  for (i = 0; i < sizeof bss; i += PAGE_SIZE)
+    if (bss[i] != value)
+      return false;
+  return *stack == value;
+}
+
+void
+test_main (void) 
+{
+  volatile char stack;
+  int fds[2];
+  pid_t pid;
+  int status;
+  char c;
+
+  fill ((char *) &stack, 'a');
+  CHECK (pipe (fds), "pipe");
+
+  msg ("fork");
+  pid = fork ();
+  if (pid == 0)
+    {
+      /* Child: wait until the parent has written, check that
+         its writes did not show through, then write. */
+      if (read (fds[0], &c, 1) != 1)
+        exit (1);
+      if (!check ((char *) &stack, 'a'))
+        exit (2);
+      fill ((char *) &stack, 'c');
+      exit (check ((char *) &stack, 'c') ? 0 : 3);
+    }
+  if (pid < 0)
+    fail ("fork returned %d", pid);
+
+  fill ((char *) &stack, 'p');
+  write (fds[1], "x", 1);
+  status = wait (pid);
+  CHECK (status == 0, "child did not see the parent's writes");
+  CHECK (check ((char *) &stack, 'p'),
+         "parent did not see the child's writes");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fork-private) begin
+(fork-private) pipe
+(fork-private) fork
+fork-private: exit(0)
+(fork-private) child did not see the parent's writes
+(fork-private) parent did not see the child's writes
+(fork-private) end
+fork-private: exit(0)
+EOF
+pass;
@@ -0,0 +1,13 @@
+/* Passes a bad pointer to the memstat system call,
+   which must cause the process to be terminated with exit code
+   -1. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  msg ("memstat(0x20101234): %d", memstat ((struct memstat *) 0x20101234));
+}
@@ -1,7 +1,6 @@
-/* Opens a file and then runs a subprocess that tries to close
-   the file.  (Pintos does not have inheritance of file handles,
-   so this must fail.)  The parent process then attempts to use
-   the file handle, which must succeed. */
+/* Opens a file and then runs a subprocess that closes the file
+   handle it inherited.  The parent process then attempts to use
+   its own file handle, which must succeed. */
 
 #include <stdio.h>
 #include <syscall.h>
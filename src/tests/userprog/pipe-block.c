@@ -0,0 +1,56 @@
+/* Forks a child that reads from a pipe, then writes several
+   times more than the pipe holds in a single call.  The child's
+   reads must wait while the pipe is empty and the parent's write
+   must wait while it is full, so that every byte arrives, in
+   order. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Bytes written, several times the pipe's capacity. */
+#define SIZE (3 * 4096 + 100)
+
+static char buf[SIZE];
+
+void
+test_main (void) 
+{
+  int fds[2];
+  pid_t pid;
+  int status;
+  int written;
+  size_t i;
+
+  CHECK (pipe (fds), "pipe");
+
+  msg ("fork");
+  pid = fork ();
+  if (pid == 0)
+    {
+      /* Child: read until everything has arrived. */
+      size_t ofs = 0;
+
+      close (fds[1]);
+      while (ofs < SIZE)
+        {
+          int n = read (fds[0], buf + ofs, SIZE - ofs);
+          if (n <= 0)
+            exit (1);
+          ofs += n;
+        }
+      for (i = 0; i < SIZE; i++)
+        if (buf[i] != (char) (i % 251))
+          exit (2);
+      exit (0);
+    }
+  if (pid < 0)
+    fail ("fork returned %d", pid);
+
+  for (i = 0; i < SIZE; i++)
+    buf[i] = i % 251;
+  written = write (fds[1], buf, SIZE);
+  status = wait (pid);
+  CHECK (written == SIZE, "write %d bytes in one call", SIZE);
+  CHECK (status == 0, "child read them all, in order");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-block) begin
+(pipe-block) pipe
+(pipe-block) fork
+pipe-block: exit(0)
+(pipe-block) write 12388 bytes in one call
+(pipe-block) child read them all, in order
+(pipe-block) end
+pipe-block: exit(0)
+EOF
+pass;
@@ -0,0 +1,23 @@
+/* Closes the only write end of a pipe that still holds data.
+   Reads must return the data and then 0, for end of file. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[8];
+  int fds[2];
+
+  CHECK (pipe (fds), "pipe");
+  CHECK (write (fds[1], "abc", 3) == 3, "write 3 bytes");
+  msg ("close write end");
+  close (fds[1]);
+  CHECK (read (fds[0], buf, sizeof buf) == 3, "read 3 bytes");
+  if (memcmp (buf, "abc", 3))
+    fail ("read back different bytes than were written");
+  CHECK (read (fds[0], buf, sizeof buf) == 0, "read returns 0 at end of file");
+}
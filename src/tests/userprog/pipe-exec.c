@@ -0,0 +1,30 @@
+/* Writes to a pipe whose write end is marked FD_CLOEXEC, then
+   runs a child that reads from the read end it inherits.  The
+   child must not inherit the write end, so once the parent
+   closes its own the child sees end of file. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char child_cmd[128];
+  int fds[2];
+  pid_t pid;
+
+  CHECK (pipe (fds), "pipe");
+  CHECK (fcntl (fds[1], F_SETFD, FD_CLOEXEC) == 0,
+         "set FD_CLOEXEC on write end");
+  CHECK (fcntl (fds[1], F_GETFD, 0) == FD_CLOEXEC,
+         "FD_CLOEXEC is set on write end");
+  CHECK (fcntl (fds[0], F_GETFD, 0) == 0, "FD_CLOEXEC is clear on read end");
+  CHECK (write (fds[1], "hello, child", 12) == 12, "write 12 bytes");
+
+  snprintf (child_cmd, sizeof child_cmd, "child-pipe %d %d", fds[0], fds[1]);
+  pid = exec (child_cmd);
+  close (fds[1]);
+  msg ("wait(exec()) = %d", wait (pid));
+}
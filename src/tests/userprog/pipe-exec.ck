@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-exec) begin
+(pipe-exec) pipe
+(pipe-exec) set FD_CLOEXEC on write end
+(pipe-exec) FD_CLOEXEC is set on write end
+(pipe-exec) FD_CLOEXEC is clear on read end
+(pipe-exec) write 12 bytes
+(child-pipe) begin
+(child-pipe) write end not inherited
+(child-pipe) read "hello, child"
+(child-pipe) read returns 0 at end of file
+(child-pipe) end
+child-pipe: exit(0)
+(pipe-exec) wait(exec()) = 0
+(pipe-exec) end
+pipe-exec: exit(0)
+EOF
+pass;
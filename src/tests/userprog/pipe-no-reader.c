@@ -0,0 +1,17 @@
+/* Closes the only read end of a pipe.  Writes to the pipe must
+   then fail. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int fds[2];
+
+  CHECK (pipe (fds), "pipe");
+  msg ("close read end");
+  close (fds[0]);
+  CHECK (write (fds[1], "abc", 3) == -1, "write returns -1");
+}
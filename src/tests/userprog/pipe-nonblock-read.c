@@ -0,0 +1,23 @@
+/* Reads from an empty pipe whose read end is set O_NONBLOCK.
+   The read must return -1 instead of waiting, and succeed once
+   there is data. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char c;
+  int fds[2];
+
+  CHECK (pipe (fds), "pipe");
+  CHECK (fcntl (fds[0], F_SETFL, O_NONBLOCK) == 0,
+         "set O_NONBLOCK on read end");
+  CHECK (fcntl (fds[0], F_GETFL, 0) == O_NONBLOCK,
+         "O_NONBLOCK is set on read end");
+  CHECK (read (fds[0], &c, 1) == -1, "read from empty pipe returns -1");
+  CHECK (write (fds[1], "x", 1) == 1, "write 1 byte");
+  CHECK (read (fds[0], &c, 1) == 1 && c == 'x', "read 1 byte");
+}
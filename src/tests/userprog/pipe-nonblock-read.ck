@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-nonblock-read) begin
+(pipe-nonblock-read) pipe
+(pipe-nonblock-read) set O_NONBLOCK on read end
+(pipe-nonblock-read) O_NONBLOCK is set on read end
+(pipe-nonblock-read) read from empty pipe returns -1
+(pipe-nonblock-read) write 1 byte
+(pipe-nonblock-read) read 1 byte
+(pipe-nonblock-read) end
+pipe-nonblock-read: exit(0)
+EOF
+pass;
@@ -0,0 +1,28 @@
+/* Fills a pipe through a write end set O_NONBLOCK.  A write of
+   more than fits must write only what fits, a write to the full
+   pipe must return -1 instead of waiting, and writing must work
+   again once a byte has been read. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Bytes a pipe holds. */
+#define PIPE_SIZE 4096
+
+static char buf[PIPE_SIZE + 100];
+
+void
+test_main (void) 
+{
+  int fds[2];
+
+  CHECK (pipe (fds), "pipe");
+  CHECK (fcntl (fds[1], F_SETFL, O_NONBLOCK) == 0,
+         "set O_NONBLOCK on write end");
+  CHECK (write (fds[1], buf, sizeof buf) == PIPE_SIZE,
+         "write stops when the pipe is full");
+  CHECK (write (fds[1], buf, 1) == -1, "write to full pipe returns -1");
+  CHECK (read (fds[0], buf, 1) == 1, "read 1 byte");
+  CHECK (write (fds[1], buf, 1) == 1, "write 1 byte");
+}
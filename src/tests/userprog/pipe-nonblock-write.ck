@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-nonblock-write) begin
+(pipe-nonblock-write) pipe
+(pipe-nonblock-write) set O_NONBLOCK on write end
+(pipe-nonblock-write) write stops when the pipe is full
+(pipe-nonblock-write) write to full pipe returns -1
+(pipe-nonblock-write) read 1 byte
+(pipe-nonblock-write) write 1 byte
+(pipe-nonblock-write) end
+pipe-nonblock-write: exit(0)
+EOF
+pass;
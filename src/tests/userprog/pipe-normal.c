@@ -0,0 +1,25 @@
+/* Writes to a pipe and reads the same bytes back from its other
+   end. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static const char data[] = "Through the pipe.";
+  char buf[sizeof data];
+  int fds[2];
+
+  CHECK (pipe (fds), "pipe");
+  CHECK (fds[0] > 1 && fds[1] > 1 && fds[0] != fds[1],
+         "pipe returned two new fds");
+  CHECK (write (fds[1], data, sizeof data) == sizeof data,
+         "write %zu bytes", sizeof data);
+  CHECK (read (fds[0], buf, sizeof buf) == sizeof buf,
+         "read %zu bytes", sizeof buf);
+  if (memcmp (buf, data, sizeof data))
+    fail ("read back different bytes than were written");
+}
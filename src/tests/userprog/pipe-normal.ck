@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-normal) begin
+(pipe-normal) pipe
+(pipe-normal) pipe returned two new fds
+(pipe-normal) write 18 bytes
+(pipe-normal) read 18 bytes
+(pipe-normal) end
+pipe-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,22 @@
+/* Polls the read end of an empty pipe, first without waiting and
+   then with a timeout.  Both polls must return 0, with no events
+   reported, once the timeout expires. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct pollfd pfd;
+  int fds[2];
+
+  CHECK (pipe (fds), "pipe");
+  pfd.fd = fds[0];
+  pfd.events = POLLIN;
+  CHECK (poll (&pfd, 1, 0) == 0 && pfd.revents == 0,
+         "poll with timeout 0 returns 0");
+  CHECK (poll (&pfd, 1, 100) == 0 && pfd.revents == 0,
+         "poll with timeout 100 returns 0");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(poll-timeout) begin
+(poll-timeout) pipe
+(poll-timeout) poll with timeout 0 returns 0
+(poll-timeout) poll with timeout 100 returns 0
+(poll-timeout) end
+poll-timeout: exit(0)
+EOF
+pass;
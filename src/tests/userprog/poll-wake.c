@@ -0,0 +1,58 @@
+/* Polls the read end of a pipe while a forked child waits a
+   little and then writes to the pipe and exits.  The first poll
+   must wake up with POLLIN when the data arrives, and the second
+   with POLLHUP when the child's exit closes the last write
+   end. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct pollfd pfd;
+  int fds[2];
+  int first, second, first_revents, second_revents;
+  pid_t pid;
+  int status;
+  char c;
+
+  CHECK (pipe (fds), "pipe");
+
+  msg ("fork");
+  pid = fork ();
+  if (pid == 0)
+    {
+      /* Child: give the parent time to fall asleep in poll(),
+         using a poll() that has nothing to wait for but its
+         timeout. */
+      pfd.fd = -1;
+      pfd.events = 0;
+      poll (&pfd, 1, 100);
+      write (fds[1], "x", 1);
+      exit (0);
+    }
+  if (pid < 0)
+    fail ("fork returned %d", pid);
+  close (fds[1]);
+
+  /* Print nothing until the child has exited, so that its exit
+     message comes first. */
+  pfd.fd = fds[0];
+  pfd.events = POLLIN;
+  first = poll (&pfd, 1, -1);
+  first_revents = pfd.revents;
+  if (read (fds[0], &c, 1) != 1)
+    c = 0;
+  second = poll (&pfd, 1, -1);
+  second_revents = pfd.revents;
+  status = wait (pid);
+
+  CHECK (first == 1 && (first_revents & POLLIN),
+         "poll woke up with POLLIN");
+  CHECK (c == 'x', "read the child's byte");
+  CHECK (second == 1 && (second_revents & POLLHUP),
+         "poll woke up with POLLHUP");
+  CHECK (status == 0, "wait for child");
+}
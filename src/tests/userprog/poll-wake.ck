@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(poll-wake) begin
+(poll-wake) pipe
+(poll-wake) fork
+poll-wake: exit(0)
+(poll-wake) poll woke up with POLLIN
+(poll-wake) read the child's byte
+(poll-wake) poll woke up with POLLHUP
+(poll-wake) wait for child
+(poll-wake) end
+poll-wake: exit(0)
+EOF
+pass;
@@ -0,0 +1,32 @@
+/* Checks that pread() and pwrite() transfer data at the offset
+   they are given rather than at the file position, and that they
+   leave the file position where it was. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[8];
+  int handle;
+
+  CHECK (create ("data", 0), "create \"data\"");
+  CHECK ((handle = open ("data")) > 1, "open \"data\"");
+  CHECK (write (handle, "0123456789", 10) == 10, "write 10 bytes");
+
+  seek (handle, 3);
+  CHECK (pwrite (handle, "abc", 3, 6) == 3, "pwrite 3 bytes at offset 6");
+  CHECK (tell (handle) == 3, "file position still 3");
+  CHECK (pread (handle, buf, 4, 5) == 4, "pread 4 bytes at offset 5");
+  CHECK (tell (handle) == 3, "file position still 3");
+  compare_bytes (buf, "5abc", 4, 5, "data");
+
+  CHECK (pread (handle, buf, sizeof buf, 8) == 2,
+         "pread past end of file stops short");
+  compare_bytes (buf, "c9", 2, 8, "data");
+
+  CHECK (read (handle, buf, 3) == 3, "read 3 bytes at file position");
+  compare_bytes (buf, "345", 3, 3, "data");
+}
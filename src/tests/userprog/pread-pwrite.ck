@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-pwrite) begin
+(pread-pwrite) create "data"
+(pread-pwrite) open "data"
+(pread-pwrite) write 10 bytes
+(pread-pwrite) pwrite 3 bytes at offset 6
+(pread-pwrite) file position still 3
+(pread-pwrite) pread 4 bytes at offset 5
+(pread-pwrite) file position still 3
+(pread-pwrite) pread past end of file stops short
+(pread-pwrite) read 3 bytes at file position
+(pread-pwrite) end
+pread-pwrite: exit(0)
+EOF
+pass;
@@ -0,0 +1,36 @@
+/* Passes readv() and writev() more than IOV_MAX buffers, and
+   buffers whose lengths add up to more than INT_MAX.  Both calls
+   must fail with -1 without transferring any data. */
+
+#include <limits.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static struct iovec iov[IOV_MAX + 1];
+  char buf[1];
+  size_t i;
+  int handle;
+
+  for (i = 0; i < sizeof iov / sizeof *iov; i++) 
+    {
+      iov[i].iov_base = buf;
+      iov[i].iov_len = sizeof buf;
+    }
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (readv (handle, iov, IOV_MAX + 1) == -1,
+         "readv with IOV_MAX + 1 buffers returns -1");
+  CHECK (writev (handle, iov, IOV_MAX + 1) == -1,
+         "writev with IOV_MAX + 1 buffers returns -1");
+
+  iov[1].iov_len = INT_MAX;
+  CHECK (readv (handle, iov, 2) == -1,
+         "readv of more than INT_MAX bytes returns -1");
+  CHECK (writev (handle, iov, 2) == -1,
+         "writev of more than INT_MAX bytes returns -1");
+  CHECK (tell (handle) == 0, "file position still 0");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-limits) begin
+(readv-limits) open "sample.txt"
+(readv-limits) readv with IOV_MAX + 1 buffers returns -1
+(readv-limits) writev with IOV_MAX + 1 buffers returns -1
+(readv-limits) readv of more than INT_MAX bytes returns -1
+(readv-limits) writev of more than INT_MAX bytes returns -1
+(readv-limits) file position still 0
+(readv-limits) end
+readv-limits: exit(0)
+EOF
+pass;
@@ -0,0 +1,49 @@
+/* Writes a file with writev() from several buffers, one of them
+   empty, then reads it back with readv() into buffers that add
+   up to more than the file holds, so the read stops short at end
+   of file. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static const char expected[] = "Pintos reads and writes vectors.";
+  static char x[5], y[20], z[20];
+  const size_t size = sizeof expected - 1;
+  struct iovec out[4], in[3];
+  int handle;
+
+  out[0].iov_base = (char *) expected;
+  out[0].iov_len = 7;
+  out[1].iov_base = (char *) expected + 7;
+  out[1].iov_len = 0;
+  out[2].iov_base = (char *) expected + 7;
+  out[2].iov_len = 10;
+  out[3].iov_base = (char *) expected + 17;
+  out[3].iov_len = size - 17;
+  in[0].iov_base = x;
+  in[0].iov_len = sizeof x;
+  in[1].iov_base = y;
+  in[1].iov_len = sizeof y;
+  in[2].iov_base = z;
+  in[2].iov_len = sizeof z;
+
+  CHECK (create ("vectors", 0), "create \"vectors\"");
+  CHECK ((handle = open ("vectors")) > 1, "open \"vectors\"");
+  CHECK (writev (handle, out, 4) == (int) size,
+         "writev %zu bytes from 4 buffers", size);
+  CHECK (tell (handle) == size, "tell \"vectors\" after writev");
+
+  seek (handle, 0);
+  CHECK (readv (handle, in, 3) == (int) size,
+         "readv stops short at end of file");
+  CHECK (tell (handle) == size, "tell \"vectors\" after readv");
+  compare_bytes (x, expected, sizeof x, 0, "vectors");
+  compare_bytes (y, expected + 5, sizeof y, 5, "vectors");
+  compare_bytes (z, expected + 25, size - 25, 25, "vectors");
+
+  CHECK (readv (handle, in, 3) == 0, "readv at end of file returns 0");
+}
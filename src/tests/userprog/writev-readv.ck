@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(writev-readv) begin
+(writev-readv) create "vectors"
+(writev-readv) open "vectors"
+(writev-readv) writev 32 bytes from 4 buffers
+(writev-readv) tell "vectors" after writev
+(writev-readv) readv stops short at end of file
+(writev-readv) tell "vectors" after readv
+(writev-readv) readv at end of file returns 0
+(writev-readv) end
+writev-readv: exit(0)
+EOF
+pass;
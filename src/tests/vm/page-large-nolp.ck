@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(page-large-nolp) begin
+(page-large-nolp) segment starts out zeroed
+(page-large-nolp) fill segment
+(page-large-nolp) fork
+page-large-nolp: exit(0)
+(page-large-nolp) child saw parent's data and wrote its own
+(page-large-nolp) parent's data unchanged
+(page-large-nolp) end
+page-large-nolp: exit(0)
+EOF
+pass;
@@ -0,0 +1,70 @@
+/* Writes to a 4 MB zero-filled segment that the program's
+   linker script marks with PF_LARGE, then forks and checks that
+   the parent and the child each keep their own copy.  The loader
+   backs the segment with a large page if it can, or with ordinary
+   pages if large pages are disabled or no aligned run of free
+   memory is left, so the test passes either way. */
+
+#include <stdbool.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Size of the segment. */
+#define LARGE_SIZE (4 * 1024 * 1024)
+
+/* Distance between the bytes that are written and checked. */
+#define STRIDE (16 * 4096)
+
+static char large[LARGE_SIZE] __attribute__ ((section (".bss.large")));
+
+/* Sets every STRIDE'th byte of the segment to VALUE. */
+static void
+fill (char value)
+{
+  size_t i;
+
+  for (i = 0; i < LARGE_SIZE; i += STRIDE)
+    large[i] = value;
+}
+
+/* Returns true if every STRIDE'th byte of the segment is
+   VALUE. */
+static bool
+check (char value)
+{
+  size_t i;
+
+  for (i = 0; i < LARGE_SIZE; i += STRIDE)
+    if (large[i] != value)
+      return false;
+  return true;
+}
+
+void
+test_main (void)
+{
+  pid_t pid;
+  int status;
+
+  CHECK (check (0), "segment starts out zeroed");
+  fill ('p');
+  CHECK (check ('p'), "fill segment");
+
+  msg ("fork");
+  pid = fork ();
+  if (pid == 0)
+    {
+      /* Child: sees the parent's data, then replaces it. */
+      if (!check ('p'))
+        exit (1);
+      fill ('c');
+      exit (check ('c') ? 0 : 2);
+    }
+  if (pid < 0)
+    fail ("fork returned %d", pid);
+
+  status = wait (pid);
+  CHECK (status == 0, "child saw parent's data and wrote its own");
+  CHECK (check ('p'), "parent's data unchanged");
+}
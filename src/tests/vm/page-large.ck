@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(page-large) begin
+(page-large) segment starts out zeroed
+(page-large) fill segment
+(page-large) fork
+page-large: exit(0)
+(page-large) child saw parent's data and wrote its own
+(page-large) parent's data unchanged
+(page-large) end
+page-large: exit(0)
+EOF
+pass;
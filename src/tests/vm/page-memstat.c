@@ -0,0 +1,37 @@
+/* Writes to pages that the process has not touched before and
+   checks that the memstat system call counts each of them as
+   resident and as a not-present fault. */
+
+#include <round.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Number of new pages to touch. */
+#define PAGE_CNT 8
+
+static char buf[(PAGE_CNT + 1) * 4096];
+
+void
+test_main (void)
+{
+  char *pages = (char *) ROUND_UP ((uintptr_t) buf, 4096);
+  struct memstat before, after;
+  size_t i;
+
+  CHECK (memstat (&before), "memstat before touching pages");
+  for (i = 0; i < PAGE_CNT; i++)
+    pages[i * 4096] = 1;
+  CHECK (memstat (&after), "memstat after touching pages");
+
+  CHECK (after.proc.resident_pages
+         >= before.proc.resident_pages + PAGE_CNT,
+         "resident pages grew by at least %d", PAGE_CNT);
+  CHECK (after.proc.faults.not_present
+         >= before.proc.faults.not_present + PAGE_CNT,
+         "process not-present faults grew by at least %d", PAGE_CNT);
+  CHECK (after.sys.faults.not_present
+         >= before.sys.faults.not_present + PAGE_CNT,
+         "system not-present faults grew by at least %d", PAGE_CNT);
+}
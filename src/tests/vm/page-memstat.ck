@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(page-memstat) begin
+(page-memstat) memstat before touching pages
+(page-memstat) memstat after touching pages
+(page-memstat) resident pages grew by at least 8
+(page-memstat) process not-present faults grew by at least 8
+(page-memstat) system not-present faults grew by at least 8
+(page-memstat) end
+page-memstat: exit(0)
+EOF
+pass;
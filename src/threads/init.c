@@ -26,6 +26,7 @@
 #include "userprog/process.h"
 #include "userprog/exception.h"
 #include "userprog/gdt.h"
+#include "userprog/pagedir.h"
 #include "userprog/syscall.h"
 #include "userprog/tss.h"
 #else
@@ -37,10 +38,18 @@
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
 #endif
+#ifdef VM
+#include "vm/frame.h"
+#include "vm/page.h"
+#include "vm/swap.h"
+#endif
 
 /* Page directory with kernel mappings only. */
 uint32_t *init_page_dir;
 
+/* True if the CPU supports 4 MB pages and they are enabled. */
+bool large_pages_enabled;
+
 #ifdef FILESYS
 /* -f: Format the file system? */
 static bool format_filesys;
@@ -57,8 +66,20 @@ static const char *swap_bdev_name;
 /* -ul: Maximum number of pages to put into palloc's user pool. */
 static size_t user_page_limit = SIZE_MAX;
 
+/* -kp: Percentage of free memory to put into palloc's kernel
+   pool. */
+static unsigned kernel_pool_percent = 50;
+
+/* -nolp: Leave large pages disabled even if the CPU has them? */
+static bool no_large_pages;
+
+/* CPUID feature bit and CR4 bit for 4 MB pages. */
+#define CPUID_PSE 0x00000008    /* CPUID.1:EDX: page size extension. */
+#define CR4_PSE 0x00000010      /* CR4: enable page size extension. */
+
 static void bss_init (void);
 static void paging_init (void);
+static void large_pages_init (void);
 
 static char **read_command_line (void);
 static char **parse_options (char **argv);
@@ -95,9 +116,12 @@ main (void)
           init_ram_pages * PGSIZE / 1024);
 
   /* Initialize memory system. */
-  palloc_init (user_page_limit);
+  palloc_init (user_page_limit, kernel_pool_percent);
   malloc_init ();
   paging_init ();
+#ifdef USERPROG
+  pagedir_init ();
+#endif
 
   /* Segmentation. */
 #ifdef USERPROG
@@ -117,6 +141,9 @@ main (void)
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
+#ifdef USERPROG
+  process_init ();
+#endif
   serial_init_queue ();
   timer_calibrate ();
 
@@ -127,6 +154,13 @@ main (void)
   filesys_init (format_filesys);
 #endif
 
+#ifdef VM
+  /* Initialize virtual memory. */
+  frame_init ();
+  page_init ();
+  swap_init ();
+#endif
+
   printf ("Boot complete.\n");
   
   /* Run actions specified on kernel command line. */
@@ -186,6 +220,27 @@ paging_init (void)
      to/from Control Registers" and [IA32-v3a] 3.7.5 "Base Address
      of the Page Directory". */
   asm volatile ("movl %0, %%cr3" : : "r" (vtop (init_page_dir)));
+
+  large_pages_init ();
+}
+
+/* If the CPU supports 4 MB pages, enables them by setting
+   CR4.PSE, unless the -nolp option was given.  Only user page
+   directories use them; see pagedir_set_large_page(). */
+static void
+large_pages_init (void)
+{
+  uint32_t eax = 1, ebx, ecx, edx, cr4;
+
+  if (no_large_pages)
+    return;
+  asm ("cpuid" : "+a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx));
+  if (edx & CPUID_PSE)
+    {
+      asm volatile ("movl %%cr4, %0" : "=r" (cr4));
+      asm volatile ("movl %0, %%cr4" : : "r" (cr4 | CR4_PSE));
+      large_pages_enabled = true;
+    }
 }
 
 /* Breaks the kernel command line into words and returns them as
@@ -259,6 +314,15 @@ parse_options (char **argv)
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
+      else if (!strcmp (name, "-kp"))
+        {
+          int percent = atoi (value);
+          if (percent < 1 || percent > 99)
+            PANIC ("-kp must be between 1 and 99");
+          kernel_pool_percent = percent;
+        }
+      else if (!strcmp (name, "-nolp"))
+        no_large_pages = true;
 #endif
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
@@ -381,6 +445,12 @@ usage (void)
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#ifndef VM
+          "                     Without it, a full user pool may\n"
+          "                     borrow pages from the kernel pool.\n"
+#endif
+          "  -kp=PERCENT        Give PERCENT of memory to the kernel pool.\n"
+          "  -nolp              Do not back user memory with 4 MB pages.\n"
 #endif
           );
   shutdown_power_off ();
@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/interrupt.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -32,7 +33,29 @@
    because they're too big to fit in a single page with a
    descriptor.  We handle those by allocating contiguous pages
    with the page allocator and sticking the allocation size at
-   the beginning of the allocated block's arena header. */
+   the beginning of the allocated block's arena header.
+
+   Two refinements keep the common case cheap.  First, each
+   descriptor has a "magazine", a small stack of free blocks
+   that malloc() and free() use with interrupts briefly disabled
+   instead of taking the descriptor's lock.  Pintos runs on one
+   CPU, so this is a per-CPU cache.  Only when the magazine is
+   empty (or full) do we take the lock and move a batch of blocks
+   from (or to) the free list.  Blocks in a magazine count as in
+   use as far as their arenas are concerned.  Second, a
+   descriptor keeps up to ARENA_RETAIN entirely unused arenas
+   instead of giving them back at once, so that a block
+   allocated and freed over and over doesn't take a page from the
+   page allocator and return it every time. */
+
+/* Blocks a magazine holds. */
+#define MAG_SIZE 16
+
+/* Blocks moved between a magazine and its free list at once. */
+#define MAG_BATCH (MAG_SIZE / 2)
+
+/* Unused arenas a descriptor keeps. */
+#define ARENA_RETAIN 1
 
 /* Descriptor. */
 struct desc
@@ -41,6 +64,18 @@ struct desc
     size_t blocks_per_arena;    /* Number of blocks in an arena. */
     struct list free_list;      /* List of free blocks. */
     struct lock lock;           /* Lock. */
+    size_t arena_cnt;           /* Arenas allocated. */
+    size_t empty_cnt;           /* Arenas with no blocks in use. */
+
+    /* Magazine, protected by disabling interrupts. */
+    struct block *mag[MAG_SIZE]; /* Free blocks, most recent last. */
+    size_t mag_cnt;             /* Number of blocks in MAG. */
+
+    /* Statistics, protected by disabling interrupts. */
+    unsigned long long alloc_cnt;   /* Calls to malloc(). */
+    unsigned long long free_cnt;    /* Calls to free(). */
+    unsigned long long refill_cnt;  /* Magazine refills. */
+    unsigned long long flush_cnt;   /* Magazine flushes. */
   };
 
 /* Magic number for detecting arena corruption. */
@@ -64,8 +99,13 @@ struct block
 static struct desc descs[10];   /* Descriptors. */
 static size_t desc_cnt;         /* Number of descriptors. */
 
+/* Big block statistics, protected by disabling interrupts. */
+static unsigned long long big_alloc_cnt, big_free_cnt;
+
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
+static struct block *get_block (struct desc *, bool new_arena);
+static void put_block (struct desc *, struct block *);
 
 /* Initializes the malloc() descriptors. */
 void
@@ -92,6 +132,7 @@ malloc (size_t size)
   struct desc *d;
   struct block *b;
   struct arena *a;
+  enum intr_level old_level;
 
   /* A null pointer satisfies a request for 0 bytes. */
   if (size == 0)
@@ -116,39 +157,54 @@ malloc (size_t size)
       a->magic = ARENA_MAGIC;
       a->desc = NULL;
       a->free_cnt = page_cnt;
+      old_level = intr_disable ();
+      big_alloc_cnt++;
+      intr_set_level (old_level);
       return a + 1;
     }
 
-  lock_acquire (&d->lock);
+  /* Take a block from the magazine if there is one. */
+  old_level = intr_disable ();
+  if (d->mag_cnt > 0)
+    {
+      b = d->mag[--d->mag_cnt];
+      d->alloc_cnt++;
+      intr_set_level (old_level);
+      return b;
+    }
+  intr_set_level (old_level);
 
-  /* If the free list is empty, create a new arena. */
-  if (list_empty (&d->free_list))
+  /* Otherwise take one from the free list, along with a batch
+     for the magazine. */
+  lock_acquire (&d->lock);
+  b = get_block (d, true);
+  if (b != NULL)
     {
+      struct block *extra;
       size_t i;
 
-      /* Allocate a page. */
-      a = palloc_get_page (0);
-      if (a == NULL) 
+      for (i = 1; i < MAG_BATCH && (extra = get_block (d, false)) != NULL;
+           i++)
         {
-          lock_release (&d->lock);
-          return NULL; 
+          bool stored;
+
+          old_level = intr_disable ();
+          stored = d->mag_cnt < MAG_SIZE;
+          if (stored)
+            d->mag[d->mag_cnt++] = extra;
+          intr_set_level (old_level);
+          if (!stored)
+            {
+              put_block (d, extra);
+              break;
+            }
         }
 
-      /* Initialize arena and add its blocks to the free list. */
-      a->magic = ARENA_MAGIC;
-      a->desc = d;
-      a->free_cnt = d->blocks_per_arena;
-      for (i = 0; i < d->blocks_per_arena; i++) 
-        {
-          struct block *b = arena_to_block (a, i);
-          list_push_back (&d->free_list, &b->free_elem);
-        }
+      old_level = intr_disable ();
+      d->alloc_cnt++;
+      d->refill_cnt++;
+      intr_set_level (old_level);
     }
-
-  /* Get a block from free list and return it. */
-  b = list_entry (list_pop_front (&d->free_list), struct block, free_elem);
-  a = block_to_arena (b);
-  a->free_cnt--;
   lock_release (&d->lock);
   return b;
 }
@@ -223,46 +279,152 @@ free (void *p)
       struct block *b = p;
       struct arena *a = block_to_arena (b);
       struct desc *d = a->desc;
+      enum intr_level old_level;
       
       if (d != NULL) 
         {
           /* It's a normal block.  We handle it here. */
+          struct block *flush[MAG_BATCH + 1];
+          size_t i;
 
 #ifndef NDEBUG
           /* Clear the block to help detect use-after-free bugs. */
           memset (b, 0xcc, d->block_size);
 #endif
-  
-          lock_acquire (&d->lock);
-
-          /* Add block to free list. */
-          list_push_front (&d->free_list, &b->free_elem);
 
-          /* If the arena is now entirely unused, free it. */
-          if (++a->free_cnt >= d->blocks_per_arena) 
+          /* Put it in the magazine if there's room.  If not,
+             move the older half of the magazine, along with this
+             block, back to the free list. */
+          old_level = intr_disable ();
+          d->free_cnt++;
+          if (d->mag_cnt < MAG_SIZE)
             {
-              size_t i;
-
-              ASSERT (a->free_cnt == d->blocks_per_arena);
-              for (i = 0; i < d->blocks_per_arena; i++) 
-                {
-                  struct block *b = arena_to_block (a, i);
-                  list_remove (&b->free_elem);
-                }
-              palloc_free_page (a);
+              d->mag[d->mag_cnt++] = b;
+              intr_set_level (old_level);
+              return;
             }
+          memcpy (flush, d->mag, sizeof *flush * MAG_BATCH);
+          memmove (d->mag, d->mag + MAG_BATCH,
+                   sizeof *d->mag * (MAG_SIZE - MAG_BATCH));
+          d->mag_cnt -= MAG_BATCH;
+          d->flush_cnt++;
+          intr_set_level (old_level);
+          flush[MAG_BATCH] = b;
 
+          lock_acquire (&d->lock);
+          for (i = 0; i < MAG_BATCH + 1; i++)
+            put_block (d, flush[i]);
           lock_release (&d->lock);
         }
       else
         {
           /* It's a big block.  Free its pages. */
+          old_level = intr_disable ();
+          big_free_cnt++;
+          intr_set_level (old_level);
           palloc_free_multiple (a, a->free_cnt);
           return;
         }
     }
 }
-
+
+/* Prints allocation statistics for each block size in use. */
+void
+malloc_print_stats (void)
+{
+  struct desc *d;
+
+  for (d = descs; d < descs + desc_cnt; d++)
+    if (d->alloc_cnt > 0)
+      printf ("Malloc: %zu-byte blocks: %llu allocs, %llu frees, "
+              "%llu refills, %llu flushes, %zu arenas\n",
+              d->block_size, d->alloc_cnt, d->free_cnt,
+              d->refill_cnt, d->flush_cnt, d->arena_cnt);
+  printf ("Malloc: big blocks: %llu allocs, %llu frees\n",
+          big_alloc_cnt, big_free_cnt);
+}
+
+/* Removes a block from D's free list and returns it.  If the free
+   list is empty, creates a new arena if NEW_ARENA is true, or
+   returns a null pointer if it is false or memory is short.  The
+   caller must hold D's lock. */
+static struct block *
+get_block (struct desc *d, bool new_arena)
+{
+  struct block *b;
+  struct arena *a;
+
+  ASSERT (lock_held_by_current_thread (&d->lock));
+
+  /* If the free list is empty, create a new arena. */
+  if (list_empty (&d->free_list))
+    {
+      size_t i;
+
+      if (!new_arena)
+        return NULL;
+
+      /* Allocate a page. */
+      a = palloc_get_page (0);
+      if (a == NULL) 
+        return NULL; 
+
+      /* Initialize arena and add its blocks to the free list. */
+      a->magic = ARENA_MAGIC;
+      a->desc = d;
+      a->free_cnt = d->blocks_per_arena;
+      for (i = 0; i < d->blocks_per_arena; i++) 
+        {
+          struct block *b = arena_to_block (a, i);
+          list_push_back (&d->free_list, &b->free_elem);
+        }
+      d->arena_cnt++;
+      d->empty_cnt++;
+    }
+
+  /* Get a block from free list and return it. */
+  b = list_entry (list_pop_front (&d->free_list), struct block, free_elem);
+  a = block_to_arena (b);
+  if (a->free_cnt-- == d->blocks_per_arena)
+    d->empty_cnt--;
+  return b;
+}
+
+/* Returns block B to D's free list.  If its arena is now entirely
+   unused and D already keeps ARENA_RETAIN such arenas, frees the
+   arena.  The caller must hold D's lock. */
+static void
+put_block (struct desc *d, struct block *b)
+{
+  struct arena *a = block_to_arena (b);
+
+  ASSERT (lock_held_by_current_thread (&d->lock));
+  ASSERT (a->desc == d);
+
+  /* Add block to free list. */
+  list_push_front (&d->free_list, &b->free_elem);
+
+  /* If the arena is now entirely unused, keep it or free it. */
+  if (++a->free_cnt >= d->blocks_per_arena) 
+    {
+      size_t i;
+
+      ASSERT (a->free_cnt == d->blocks_per_arena);
+      if (d->empty_cnt < ARENA_RETAIN)
+        {
+          d->empty_cnt++;
+          return;
+        }
+      for (i = 0; i < d->blocks_per_arena; i++) 
+        {
+          struct block *b = arena_to_block (a, i);
+          list_remove (&b->free_elem);
+        }
+      d->arena_cnt--;
+      palloc_free_page (a);
+    }
+}
+
 /* Returns the arena that block B is inside. */
 static struct arena *
 block_to_arena (struct block *b)
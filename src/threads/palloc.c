@@ -2,13 +2,14 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/interrupt.h"
 #include "threads/loader.h"
-#include "threads/synch.h"
 #include "threads/vaddr.h"
 
 /* Page allocator.  Hands out memory in page-size (or
@@ -23,39 +24,111 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+   The -kp boot option changes the split.
+
+   The split need not be exact, because a pool that runs dry
+   borrows pages from the other one, as long as the lender keeps
+   at least a quarter of its pages free for its own users.  A
+   borrowed page still belongs to the lender: freeing it returns
+   it there.  The user pool does not borrow if its size was
+   limited with -ul, which would defeat the limit, or under VM,
+   where a full user pool should make the frame allocator evict
+   a page instead. */
+
+/* Free pages are managed with a binary buddy system.  A free
+   block of order K is 2**K pages whose physical page number is a
+   multiple of 2**K; the two halves of such a block are buddies.
+   Each pool keeps a list of free blocks of each order, linked
+   through the free pages themselves.  Allocation takes the
+   smallest block that is big enough, splitting it in half as
+   many times as needed, and gives back any pages left over past
+   the end of the request.  Freeing merges a block with its buddy
+   for as long as the buddy is free too.  Both take O(log n)
+   steps, and because blocks are aligned on their size, a request
+   for N pages aligned on N pages costs nothing extra.
+
+   The pool structures are protected by disabling interrupts
+   rather than by a lock, because pages are sometimes freed with
+   interrupts off (e.g. a dying thread's stack).  Every critical
+   section is short: no page contents are touched inside one. */
+
+/* Largest block order: 2**15 pages, or 128 MB. */
+#define MAX_ORDER 15
+
+/* A pool lends pages only while more than 1/LEND_RESERVE of its
+   pages would stay free. */
+#define LEND_RESERVE 4
 
 /* A memory pool. */
 struct pool
   {
-    struct lock lock;                   /* Mutual exclusion. */
-    struct bitmap *used_map;            /* Bitmap of free pages. */
+    struct bitmap *used_map;            /* Bitmap of pages in use. */
+    struct bitmap *lent_map;            /* Pages lent to the other pool. */
+    uint8_t *free_order;                /* Per page: 1 + order if the
+                                           page heads a free block,
+                                           otherwise 0. */
+    struct list free_lists[MAX_ORDER + 1]; /* Free blocks by order. */
     uint8_t *base;                      /* Base of pool. */
+    size_t base_no;                     /* Physical page number of BASE. */
+    size_t used_cnt;                    /* Pages in use. */
+    size_t peak_cnt;                    /* Maximum of USED_CNT. */
+    size_t lent_cnt;                    /* Pages lent to the other pool. */
+    size_t lent_peak;                   /* Maximum of LENT_CNT. */
+  };
+
+/* The first page of a free block, which links it into a free
+   list. */
+struct free_block
+  {
+    struct list_elem elem;
   };
 
 /* Two pools: one for kernel data, one for user pages. */
 static struct pool kernel_pool, user_pool;
 
+/* Whether the user pool may borrow from the kernel pool. */
+static bool user_may_borrow;
+
+/* Most pages ever held for user memory at once, borrowed pages
+   included. */
+static size_t user_held_peak;
+
 static void init_pool (struct pool *, void *base, size_t page_cnt,
                        const char *name);
 static bool page_from_pool (const struct pool *, void *page);
+static void print_pool_stats (struct pool *, const char *name);
+static size_t alloc_pages (struct pool *, size_t page_cnt, size_t align);
+static size_t lend_pages (struct pool *, size_t page_cnt, size_t align);
+static void release_pages (struct pool *, size_t page_idx, size_t page_cnt);
+static size_t user_held_cnt (void);
 
-/* Initializes the page allocator.  At most USER_PAGE_LIMIT
-   pages are put into the user pool. */
+/* Initializes the page allocator.  KERNEL_PERCENT percent of
+   free memory goes to the kernel pool and the rest to the user
+   pool, but at most USER_PAGE_LIMIT pages are put into the user
+   pool, and if USER_PAGE_LIMIT is not SIZE_MAX the user pool
+   never borrows. */
 void
-palloc_init (size_t user_page_limit)
+palloc_init (size_t user_page_limit, unsigned kernel_percent)
 {
   /* Free memory starts at 1 MB and runs to the end of RAM. */
   uint8_t *free_start = ptov (1024 * 1024);
   uint8_t *free_end = ptov (init_ram_pages * PGSIZE);
   size_t free_pages = (free_end - free_start) / PGSIZE;
-  size_t user_pages = free_pages / 2;
+  size_t user_pages = free_pages - free_pages * kernel_percent / 100;
   size_t kernel_pages;
+
+  ASSERT (kernel_percent > 0 && kernel_percent < 100);
   if (user_pages > user_page_limit)
     user_pages = user_page_limit;
   kernel_pages = free_pages - user_pages;
+#ifdef VM
+  user_may_borrow = false;
+#else
+  user_may_borrow = user_page_limit == SIZE_MAX;
+#endif
 
-  /* Give half of memory to kernel, half to user. */
+  /* Split memory between kernel and user. */
   init_pool (&kernel_pool, free_start, kernel_pages, "kernel pool");
   init_pool (&user_pool, free_start + kernel_pages * PGSIZE,
              user_pages, "user pool");
@@ -63,29 +136,52 @@ palloc_init (size_t user_page_limit)
 
 /* Obtains and returns a group of PAGE_CNT contiguous free pages.
    If PAL_USER is set, the pages are obtained from the user pool,
-   otherwise from the kernel pool.  If PAL_ZERO is set in FLAGS,
+   otherwise from the kernel pool, or borrowed from the other pool
+   if that one is out and borrowing is allowed (see the comment at
+   the top of the file).  If PAL_ZERO is set in FLAGS,
    then the pages are filled with zeros.  If too few pages are
    available, returns a null pointer, unless PAL_ASSERT is set in
    FLAGS, in which case the kernel panics. */
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
+{
+  return palloc_get_aligned (flags, page_cnt, 1);
+}
+
+/* Like palloc_get_multiple(), but the physical address of the
+   first page is a multiple of ALIGN pages, which must be a power
+   of 2.  Used to back large pages, which must be aligned on their
+   size. */
+void *
+palloc_get_aligned (enum palloc_flags flags, size_t page_cnt, size_t align)
 {
   struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
   void *pages;
   size_t page_idx;
+  enum intr_level old_level;
 
+  ASSERT (align > 0 && (align & (align - 1)) == 0);
   if (page_cnt == 0)
     return NULL;
 
-  lock_acquire (&pool->lock);
-  page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-  lock_release (&pool->lock);
-
+  old_level = intr_disable ();
+  page_idx = alloc_pages (pool, page_cnt, align);
+  if (page_idx == BITMAP_ERROR && (pool == &kernel_pool || user_may_borrow))
+    {
+      pool = pool == &kernel_pool ? &user_pool : &kernel_pool;
+      page_idx = lend_pages (pool, page_cnt, align);
+    }
   if (page_idx != BITMAP_ERROR)
-    pages = pool->base + PGSIZE * page_idx;
-  else
-    pages = NULL;
+    {
+      pool->used_cnt += page_cnt;
+      if (pool->used_cnt > pool->peak_cnt)
+        pool->peak_cnt = pool->used_cnt;
+      if ((flags & PAL_USER) && user_held_cnt () > user_held_peak)
+        user_held_peak = user_held_cnt ();
+    }
+  intr_set_level (old_level);
 
+  pages = page_idx != BITMAP_ERROR ? pool->base + PGSIZE * page_idx : NULL;
   if (pages != NULL) 
     {
       if (flags & PAL_ZERO)
@@ -119,6 +215,7 @@ palloc_free_multiple (void *pages, size_t page_cnt)
 {
   struct pool *pool;
   size_t page_idx;
+  enum intr_level old_level;
 
   ASSERT (pg_ofs (pages) == 0);
   if (pages == NULL || page_cnt == 0)
@@ -137,8 +234,18 @@ palloc_free_multiple (void *pages, size_t page_cnt)
   memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
 
+  old_level = intr_disable ();
   ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
   bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+  if (pool->lent_cnt > 0)
+    {
+      pool->lent_cnt -= bitmap_count (pool->lent_map, page_idx, page_cnt,
+                                      true);
+      bitmap_set_multiple (pool->lent_map, page_idx, page_cnt, false);
+    }
+  release_pages (pool, page_idx, page_cnt);
+  pool->used_cnt -= page_cnt;
+  intr_set_level (old_level);
 }
 
 /* Frees the page at PAGE. */
@@ -148,25 +255,244 @@ palloc_free_page (void *page)
   palloc_free_multiple (page, 1);
 }
 
+/* Returns the order of the smallest block that holds PAGE_CNT
+   pages. */
+static int
+order_for (size_t page_cnt)
+{
+  int order = 0;
+
+  while (((size_t) 1 << order) < page_cnt)
+    order++;
+  return order;
+}
+
+/* Removes the free block of order ORDER at PAGE_IDX in POOL from
+   its free list. */
+static void
+take_block (struct pool *pool, size_t page_idx, int order)
+{
+  struct free_block *b = (struct free_block *) (pool->base
+                                                + PGSIZE * page_idx);
+
+  ASSERT (pool->free_order[page_idx] == order + 1);
+  list_remove (&b->elem);
+  pool->free_order[page_idx] = 0;
+}
+
+/* Adds the block of order ORDER at PAGE_IDX in POOL to its free
+   list, without merging. */
+static void
+put_block (struct pool *pool, size_t page_idx, int order)
+{
+  struct free_block *b = (struct free_block *) (pool->base
+                                                + PGSIZE * page_idx);
+
+  pool->free_order[page_idx] = order + 1;
+  list_push_front (&pool->free_lists[order], &b->elem);
+}
+
+/* Frees the block of order ORDER at PAGE_IDX in POOL, merging it
+   with its buddy, and the result with its buddy, and so on, for
+   as long as the buddy is free. */
+static void
+free_block (struct pool *pool, size_t page_idx, int order)
+{
+  size_t pool_size = bitmap_size (pool->used_map);
+
+  for (; order < MAX_ORDER; order++)
+    {
+      size_t buddy_no = (pool->base_no + page_idx) ^ ((size_t) 1 << order);
+      size_t buddy_idx = buddy_no - pool->base_no;
+
+      if (buddy_no < pool->base_no || buddy_idx >= pool_size
+          || pool->free_order[buddy_idx] != order + 1)
+        break;
+      take_block (pool, buddy_idx, order);
+      if (buddy_idx < page_idx)
+        page_idx = buddy_idx;
+    }
+  put_block (pool, page_idx, order);
+}
+
+/* Frees the PAGE_CNT pages at PAGE_IDX in POOL, which need not
+   form a single block, as the largest aligned blocks that fit. */
+static void
+release_pages (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+  while (page_cnt > 0)
+    {
+      size_t page_no = pool->base_no + page_idx;
+      int order = 0;
+
+      while (order < MAX_ORDER
+             && (page_no & (((size_t) 2 << order) - 1)) == 0
+             && ((size_t) 2 << order) <= page_cnt)
+        order++;
+      free_block (pool, page_idx, order);
+      page_idx += (size_t) 1 << order;
+      page_cnt -= (size_t) 1 << order;
+    }
+}
+
+/* Allocates PAGE_CNT pages in POOL whose physical address is a
+   multiple of ALIGN pages and marks them used.  Returns the index
+   of the first one, or BITMAP_ERROR if there is no such run.
+   Interrupts must be off. */
+static size_t
+alloc_pages (struct pool *pool, size_t page_cnt, size_t align)
+{
+  int order = order_for (page_cnt > align ? page_cnt : align);
+  int o;
+  size_t page_idx;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  /* Find the smallest free block that is big enough. */
+  for (o = order; o <= MAX_ORDER; o++)
+    if (!list_empty (&pool->free_lists[o]))
+      break;
+  if (o > MAX_ORDER)
+    return BITMAP_ERROR;
+  page_idx = ((uint8_t *) list_front (&pool->free_lists[o])
+              - pool->base) / PGSIZE;
+  take_block (pool, page_idx, o);
+
+  /* Split it down to size, freeing the upper halves. */
+  while (o > order)
+    {
+      o--;
+      put_block (pool, page_idx + ((size_t) 1 << o), o);
+    }
+
+  /* Give back the pages past the end of the request. */
+  release_pages (pool, page_idx + page_cnt, ((size_t) 1 << order) - page_cnt);
+
+  ASSERT (bitmap_none (pool->used_map, page_idx, page_cnt));
+  bitmap_set_multiple (pool->used_map, page_idx, page_cnt, true);
+  return page_idx;
+}
+
+/* Allocates PAGE_CNT pages aligned on ALIGN pages from POOL on
+   behalf of the other pool, which is out of pages.  Fails, by
+   returning BITMAP_ERROR, if that would leave POOL with no more
+   than 1/LEND_RESERVE of its pages free.  Interrupts must be
+   off. */
+static size_t
+lend_pages (struct pool *pool, size_t page_cnt, size_t align)
+{
+  size_t pool_size = bitmap_size (pool->used_map);
+  size_t page_idx;
+
+  if (pool->used_cnt + page_cnt + pool_size / LEND_RESERVE >= pool_size)
+    return BITMAP_ERROR;
+  page_idx = alloc_pages (pool, page_cnt, align);
+  if (page_idx != BITMAP_ERROR)
+    {
+      bitmap_set_multiple (pool->lent_map, page_idx, page_cnt, true);
+      pool->lent_cnt += page_cnt;
+      if (pool->lent_cnt > pool->lent_peak)
+        pool->lent_peak = pool->lent_cnt;
+    }
+  return page_idx;
+}
+
+/* Returns the number of pages held for user memory: the user
+   pool's pages in use, less those it lent to the kernel pool,
+   plus those it borrowed from the kernel pool.  Interrupts must
+   be off. */
+static size_t
+user_held_cnt (void)
+{
+  return user_pool.used_cnt - user_pool.lent_cnt + kernel_pool.lent_cnt;
+}
+
+/* Stores the size of the user pool, the number of pages held for
+   user memory, and the most that have ever been held at once
+   into *SIZE, *USED, and *PEAK.  Pages the user pool borrowed
+   count as held, so *USED may exceed *SIZE. */
+void
+palloc_user_stats (size_t *size, size_t *used, size_t *peak)
+{
+  enum intr_level old_level = intr_disable ();
+  *size = bitmap_size (user_pool.used_map);
+  *used = user_held_cnt ();
+  *peak = user_held_peak;
+  intr_set_level (old_level);
+}
+
+/* Prints page allocator statistics. */
+void
+palloc_print_stats (void)
+{
+  print_pool_stats (&kernel_pool, "kernel pool");
+  print_pool_stats (&user_pool, "user pool");
+}
+
+/* Prints usage and fragmentation statistics for POOL, named
+   NAME.  Fragmentation is the share of free pages that lie
+   outside the largest free block, so 0% means all free memory
+   could be handed out as one run. */
+static void
+print_pool_stats (struct pool *pool, const char *name)
+{
+  size_t free_cnt = bitmap_size (pool->used_map) - pool->used_cnt;
+  size_t largest = 0;
+  int order;
+
+  printf ("Palloc: %s: %zu of %zu pages in use, peak %zu\n",
+          name, pool->used_cnt, bitmap_size (pool->used_map),
+          pool->peak_cnt);
+  printf ("Palloc: %s: %zu pages lent to the other pool, peak %zu\n",
+          name, pool->lent_cnt, pool->lent_peak);
+  printf ("Palloc: %s: free blocks by order:", name);
+  for (order = 0; order <= MAX_ORDER; order++)
+    {
+      size_t cnt = list_size (&pool->free_lists[order]);
+      if (cnt > 0)
+        {
+          printf (" %d:%zu", order, cnt);
+          largest = (size_t) 1 << order;
+        }
+    }
+  printf ("; largest %zu pages, %zu%% fragmented\n", largest,
+          free_cnt > 0 ? (free_cnt - largest) * 100 / free_cnt : 0);
+}
+
 /* Initializes pool P as starting at START and ending at END,
    naming it NAME for debugging purposes. */
 static void
 init_pool (struct pool *p, void *base, size_t page_cnt, const char *name) 
 {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
-     and subtract it from the pool's size. */
-  size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (page_cnt), PGSIZE);
+  /* We'll put the pool's used_map, lent_map and free_order array
+     at its base.  Calculate the space needed for them and
+     subtract it from the pool's size. */
+  size_t bm_pages = DIV_ROUND_UP (2 * bitmap_buf_size (page_cnt) + page_cnt,
+                                  PGSIZE);
+  size_t bm_size = bitmap_buf_size (page_cnt);
+  int order;
+
   if (bm_pages > page_cnt)
     PANIC ("Not enough memory in %s for bitmap.", name);
   page_cnt -= bm_pages;
 
   printf ("%zu pages available in %s.\n", page_cnt, name);
 
-  /* Initialize the pool. */
-  lock_init (&p->lock);
-  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_pages * PGSIZE);
+  /* Initialize the pool, with every page free. */
+  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_size);
+  p->lent_map = bitmap_create_in_buf (page_cnt, (uint8_t *) base + bm_size,
+                                      bm_size);
+  p->free_order = (uint8_t *) base + 2 * bm_size;
+  memset (p->free_order, 0, page_cnt);
+  for (order = 0; order <= MAX_ORDER; order++)
+    list_init (&p->free_lists[order]);
   p->base = base + bm_pages * PGSIZE;
+  p->base_no = vtop (p->base) / PGSIZE;
+  p->used_cnt = 0;
+  p->peak_cnt = 0;
+  p->lent_cnt = 0;
+  p->lent_peak = 0;
+  release_pages (p, 0, page_cnt);
 }
 
 /* Returns true if PAGE was allocated from POOL,
@@ -11,10 +11,13 @@ enum palloc_flags
     PAL_USER = 004              /* User page. */
   };
 
-void palloc_init (size_t user_page_limit);
+void palloc_init (size_t user_page_limit, unsigned kernel_percent);
 void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
+void *palloc_get_aligned (enum palloc_flags, size_t page_cnt, size_t align);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+void palloc_user_stats (size_t *size, size_t *used, size_t *peak);
+void palloc_print_stats (void);
 
 #endif /* threads/palloc.h */
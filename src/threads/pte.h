@@ -66,6 +66,17 @@ static inline uintptr_t pd_no (const void *va) {
 #define PTE_U 0x4               /* 1=user/kernel, 0=kernel only. */
 #define PTE_A 0x20              /* 1=accessed, 0=not acccessed. */
 #define PTE_D 0x40              /* 1=dirty, 0=not dirty (PTEs only). */
+#define PDE_PS 0x80             /* 1=4 MB page, 0=page table (PDEs only). */
+
+/* Large pages.
+
+   With CR4.PSE set, a PDE with PDE_PS set maps a whole 4 MB
+   region directly, with no page table, to a 4 MB-aligned run of
+   physical memory.  Such a PDE has the same flags as a PTE,
+   including PTE_A and PTE_D.  See [IA32-v3a] 3.7.3 "Mixing 4-KByte
+   and 4-MByte Pages". */
+#define LGSIZE  PTSPAN                     /* Bytes in a large page. */
+#define LGPGCNT (LGSIZE / PGSIZE)          /* Pages in a large page. */
 
 /* Returns a PDE that points to page table PT. */
 static inline uint32_t pde_create (uint32_t *pt) {
@@ -97,6 +108,15 @@ static inline uint32_t pte_create_user (void *page, bool writable) {
   return pte_create_kernel (page, writable) | PTE_U;
 }
 
+/* Returns a PDE that maps the large page at PAGE, which must be
+   aligned on a LGSIZE boundary in physical memory.  The page is
+   readable by both user and kernel code, and writable if
+   WRITABLE is true. */
+static inline uint32_t pde_create_large (void *page, bool writable) {
+  ASSERT (vtop (page) % LGSIZE == 0);
+  return vtop (page) | PDE_PS | PTE_U | PTE_P | (writable ? PTE_W : 0);
+}
+
 /* Returns a pointer to the page that page table entry PTE points
    to. */
 static inline void *pte_get_page (uint32_t pte) {
@@ -0,0 +1,256 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Slab allocator for fixed-size kernel objects.
+
+   A cache hands out objects of exactly one size, rounded up only
+   to a word boundary, instead of the next power of 2 as malloc()
+   does.  Objects live in "slabs", each of which is one page from
+   the page allocator with a header at its start, followed by a
+   stack of the indexes of its free objects, followed by the
+   objects themselves.  Keeping the free list outside the objects
+   means that a freed object is left untouched, so a cache with a
+   constructor runs it only once per object, when its slab is
+   created: objects must be freed in their constructed state,
+   e.g. with any locks they contain released.
+
+   A cache keeps its slabs with free objects on one list, partly
+   used slabs before unused ones so that allocations fill slabs
+   up, and its full slabs on another.  It keeps one unused slab
+   around rather than returning it to the page allocator, so an
+   object that is allocated and freed over and over doesn't cost
+   a page each time.
+
+   Caches are created once, at initialization time, and are never
+   destroyed. */
+
+/* Most caches that can be created. */
+#define SLAB_CACHE_MAX 16
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab51ab
+
+/* A cache of objects of one size. */
+struct slab_cache
+  {
+    const char *name;           /* Name, for statistics. */
+    size_t obj_size;            /* Size of each object in bytes. */
+    size_t objs_per_slab;       /* Number of objects in a slab. */
+    size_t objs_ofs;            /* Offset of first object in a slab. */
+    slab_ctor_func *ctor;       /* Constructor, or a null pointer. */
+    struct lock lock;           /* Protects members below. */
+    struct list free_slabs;     /* Slabs with free objects. */
+    struct list full_slabs;     /* Slabs with no free objects. */
+    size_t slab_cnt;            /* Number of slabs. */
+    size_t empty_cnt;           /* Number of unused slabs. */
+    size_t used_cnt;            /* Objects in use. */
+    size_t peak_cnt;            /* Maximum of USED_CNT. */
+  };
+
+/* A slab: the header at the start of a page of objects. */
+struct slab
+  {
+    unsigned magic;             /* Always set to SLAB_MAGIC. */
+    struct slab_cache *cache;   /* Owning cache. */
+    struct list_elem elem;      /* Element in a cache's slab list. */
+    size_t free_cnt;            /* Number of free objects. */
+    uint16_t free_idx[];        /* Indexes of free objects. */
+  };
+
+static struct slab_cache caches[SLAB_CACHE_MAX];
+static size_t cache_cnt;
+
+static struct slab *new_slab (struct slab_cache *);
+static void *slab_obj (struct slab_cache *, struct slab *, size_t idx);
+
+/* Returns the offset of the first object in a slab of OBJ_CNT
+   objects. */
+static size_t
+objs_ofs (size_t obj_cnt)
+{
+  return ROUND_UP (sizeof (struct slab) + obj_cnt * sizeof (uint16_t),
+                   sizeof (void *));
+}
+
+/* Creates and returns a cache of objects of SIZE bytes named
+   NAME.  If CTOR is nonnull, it is called on each object once,
+   when the object's slab is created.  Allocates no memory, so it
+   may be called at any point during initialization. */
+struct slab_cache *
+slab_create (const char *name, size_t size, slab_ctor_func *ctor)
+{
+  struct slab_cache *c;
+
+  ASSERT (cache_cnt < SLAB_CACHE_MAX);
+  ASSERT (size > 0);
+
+  c = &caches[cache_cnt++];
+  c->name = name;
+  c->obj_size = ROUND_UP (size, sizeof (void *));
+  c->objs_per_slab = (PGSIZE - objs_ofs (0)) / (c->obj_size
+                                                + sizeof (uint16_t));
+  while (objs_ofs (c->objs_per_slab) + c->objs_per_slab * c->obj_size
+         > PGSIZE)
+    c->objs_per_slab--;
+  ASSERT (c->objs_per_slab > 0);
+  c->objs_ofs = objs_ofs (c->objs_per_slab);
+  c->ctor = ctor;
+  lock_init (&c->lock);
+  list_init (&c->free_slabs);
+  list_init (&c->full_slabs);
+  c->slab_cnt = c->empty_cnt = 0;
+  c->used_cnt = c->peak_cnt = 0;
+  return c;
+}
+
+/* Obtains and returns an object from cache C.  The object is in
+   the state its constructor or its last user left it.  Returns a
+   null pointer if memory is not available. */
+void *
+slab_alloc (struct slab_cache *c)
+{
+  struct slab *s;
+  void *obj;
+
+  lock_acquire (&c->lock);
+  if (list_empty (&c->free_slabs))
+    {
+      s = new_slab (c);
+      if (s == NULL)
+        {
+          lock_release (&c->lock);
+          return NULL;
+        }
+      list_push_front (&c->free_slabs, &s->elem);
+    }
+  else
+    s = list_entry (list_front (&c->free_slabs), struct slab, elem);
+
+  if (s->free_cnt == c->objs_per_slab)
+    c->empty_cnt--;
+  obj = slab_obj (c, s, s->free_idx[--s->free_cnt]);
+  if (s->free_cnt == 0)
+    {
+      list_remove (&s->elem);
+      list_push_back (&c->full_slabs, &s->elem);
+    }
+  if (++c->used_cnt > c->peak_cnt)
+    c->peak_cnt = c->used_cnt;
+  lock_release (&c->lock);
+
+  return obj;
+}
+
+/* Returns OBJ, which must have been obtained from cache C with
+   slab_alloc(), to C.  Does nothing if OBJ is null. */
+void
+slab_free (struct slab_cache *c, void *obj)
+{
+  struct slab *s;
+  size_t idx;
+
+  if (obj == NULL)
+    return;
+
+  s = pg_round_down (obj);
+  ASSERT (s->magic == SLAB_MAGIC);
+  ASSERT (s->cache == c);
+  idx = ((uint8_t *) obj - ((uint8_t *) s + c->objs_ofs)) / c->obj_size;
+  ASSERT (obj == slab_obj (c, s, idx));
+
+#ifndef NDEBUG
+  /* Clear the object to help detect use-after-free bugs, unless
+     it must keep its constructed state. */
+  if (c->ctor == NULL)
+    memset (obj, 0xcc, c->obj_size);
+#endif
+
+  lock_acquire (&c->lock);
+  ASSERT (s->free_cnt < c->objs_per_slab);
+  if (s->free_cnt == 0)
+    {
+      /* It was full. */
+      list_remove (&s->elem);
+      list_push_front (&c->free_slabs, &s->elem);
+    }
+  s->free_idx[s->free_cnt++] = idx;
+  c->used_cnt--;
+
+  if (s->free_cnt == c->objs_per_slab)
+    {
+      /* It is now unused.  Keep one such slab, behind the partly
+         used ones. */
+      list_remove (&s->elem);
+      if (c->empty_cnt == 0)
+        {
+          c->empty_cnt++;
+          list_push_back (&c->free_slabs, &s->elem);
+        }
+      else
+        {
+          c->slab_cnt--;
+          palloc_free_page (s);
+        }
+    }
+  lock_release (&c->lock);
+}
+
+/* Prints statistics for each cache. */
+void
+slab_print_stats (void)
+{
+  size_t i;
+
+  for (i = 0; i < cache_cnt; i++)
+    {
+      struct slab_cache *c = &caches[i];
+      printf ("Slab: %s: %zu-byte objects, %zu in use, peak %zu, "
+              "%zu slabs of %zu\n",
+              c->name, c->obj_size, c->used_cnt, c->peak_cnt,
+              c->slab_cnt, c->objs_per_slab);
+    }
+}
+
+/* Creates a new slab for cache C, with all of its objects free
+   and constructed, and returns it, or a null pointer if memory
+   is short.  The caller must hold C's lock. */
+static struct slab *
+new_slab (struct slab_cache *c)
+{
+  struct slab *s;
+  size_t i;
+
+  s = palloc_get_page (0);
+  if (s == NULL)
+    return NULL;
+  s->magic = SLAB_MAGIC;
+  s->cache = c;
+  s->free_cnt = c->objs_per_slab;
+
+  /* Hand out low addresses first. */
+  for (i = 0; i < c->objs_per_slab; i++)
+    {
+      s->free_idx[i] = c->objs_per_slab - 1 - i;
+      if (c->ctor != NULL)
+        c->ctor (slab_obj (c, s, i));
+    }
+  c->slab_cnt++;
+  c->empty_cnt++;
+  return s;
+}
+
+/* Returns the object with index IDX in slab S of cache C. */
+static void *
+slab_obj (struct slab_cache *c, struct slab *s, size_t idx)
+{
+  ASSERT (idx < c->objs_per_slab);
+  return (uint8_t *) s + c->objs_ofs + idx * c->obj_size;
+}
@@ -336,3 +336,66 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   while (!list_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/* Initializes wait queue Q as empty. */
+void
+wait_queue_init (struct wait_queue *q)
+{
+  ASSERT (q != NULL);
+
+  list_init (&q->entries);
+}
+
+/* Adds entry E to wait queue Q, so that SEMA is upped the next
+   time Q is woken.  E must later be taken off Q with
+   wait_queue_remove(). */
+void
+wait_queue_add (struct wait_queue *q, struct wait_entry *e,
+                struct semaphore *sema)
+{
+  enum intr_level old_level;
+
+  ASSERT (q != NULL);
+  ASSERT (e != NULL);
+  ASSERT (sema != NULL);
+
+  old_level = intr_disable ();
+  e->sema = sema;
+  e->queue = q;
+  list_push_back (&q->entries, &e->elem);
+  intr_set_level (old_level);
+}
+
+/* Takes entry E off the wait queue it was added to, if any. */
+void
+wait_queue_remove (struct wait_entry *e)
+{
+  enum intr_level old_level;
+
+  ASSERT (e != NULL);
+
+  old_level = intr_disable ();
+  if (e->queue != NULL)
+    {
+      list_remove (&e->elem);
+      e->queue = NULL;
+    }
+  intr_set_level (old_level);
+}
+
+/* Ups the semaphore of every entry on wait queue Q.  The entries
+   stay on Q.  May be called from an interrupt handler. */
+void
+wait_queue_wake (struct wait_queue *q)
+{
+  enum intr_level old_level;
+  struct list_elem *e;
+
+  ASSERT (q != NULL);
+
+  old_level = intr_disable ();
+  for (e = list_begin (&q->entries); e != list_end (&q->entries);
+       e = list_next (e))
+    sema_up (list_entry (e, struct wait_entry, elem)->sema);
+  intr_set_level (old_level);
+}
@@ -41,6 +41,30 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Wait queue.
+   Threads that wait for any of several objects to change state
+   (see the poll system call) put an entry on each object's wait
+   queue, then down a semaphore of their own.  The object wakes
+   up every entry whenever its state changes. */
+struct wait_queue
+  {
+    struct list entries;        /* List of wait_entry. */
+  };
+
+/* An entry in a wait queue. */
+struct wait_entry
+  {
+    struct semaphore *sema;     /* Upped when the queue is woken. */
+    struct wait_queue *queue;   /* Queue the entry is on, if any. */
+    struct list_elem elem;      /* Element in QUEUE's entries. */
+  };
+
+void wait_queue_init (struct wait_queue *);
+void wait_queue_add (struct wait_queue *, struct wait_entry *,
+                     struct semaphore *);
+void wait_queue_remove (struct wait_entry *);
+void wait_queue_wake (struct wait_queue *);
+
 /* Optimization barrier.
 
    The compiler will not reorder operations across an
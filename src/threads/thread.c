@@ -11,7 +11,7 @@
 #include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
-#include "threads/malloc.h"
+#include "threads/slab.h"
 /* FS code */
 #include "filesys/directory.h"
 
@@ -35,6 +35,9 @@ static struct list all_list;
 /* Idle thread. */
 static struct thread *idle_thread;
 
+/* Cache of child_nodes, freed by userprog/process.c. */
+struct slab_cache *child_node_cache;
+
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
 
@@ -96,6 +99,8 @@ thread_init (void)
   lock_init (&tid_lock);
   list_init (&ready_list);
   list_init (&all_list);
+  child_node_cache = slab_create ("child_node", sizeof (struct child_node),
+                                  NULL);
 
 
   /* Set up a thread structure for the running thread. */
@@ -192,12 +197,14 @@ thread_create (const char *name, int priority,
   
 
   /* my code */
-  list_init (&t->file_list);   // initialize file list
-  t->fd = 2;      // init fd=2, which is neither 0(STDIN_FILENO) or 1(STDOUT_FILENO)
+  t->fd_table = NULL;   // fd table grows on first open
+  t->fd_cnt = 0;
+  t->fd_next = 2;      // first fd is 2, which is neither 0(STDIN_FILENO) or 1(STDOUT_FILENO)
+  t->stdin_nonblock = false;
   t->parent = thread_current();
   
   /* push the child_node to its parent's child_list */
-  struct child_node * cnode = malloc(sizeof(struct child_node));
+  struct child_node * cnode = slab_alloc(child_node_cache);
   cnode->pid = t->tid;  
   cnode->exited = 0;
   cnode->load_success=0;
@@ -576,7 +583,14 @@ thread_schedule_tail (struct thread *prev)
   if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread) 
     {
       ASSERT (prev != cur);
-      palloc_free_page (prev);
+#ifdef USERPROG
+      /* A user process's memory and files are released by the
+         reaper, which frees its struct thread afterward. */
+      if (prev->pagedir != NULL)
+        process_reap (prev);
+      else
+#endif
+        palloc_free_page (prev);
     }
 }
 
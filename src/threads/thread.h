@@ -2,7 +2,9 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <hash.h>
 #include <list.h>
+#include <memstat.h>
 #include <stdint.h>
 #include "threads/synch.h"
 #include "filesys/file.h"
@@ -41,6 +43,8 @@ struct child_node
   struct list_elem elem;
 };
 
+extern struct slab_cache *child_node_cache;
+
 /* A kernel thread or user process.
 
    Each thread structure is stored in its own 4 kB page.  The
@@ -114,8 +118,10 @@ struct thread
     int exit_code;                      /* exit code to printed */
     
     // File Syscall
-    struct list file_list;              /* Each thread has its file list */
-    int fd;                             /* file discriptor, to describe file num? */
+    struct file_node **fd_table;        /* Open files, indexed by fd. */
+    int fd_cnt;                         /* Number of slots in fd_table. */
+    int fd_next;                        /* Every fd below this is in use. */
+    bool stdin_nonblock;                /* O_NONBLOCK set on STDIN_FILENO. */
     struct list child_list;             /* store its children processes' status */
     struct semaphore exec_wait;         /* semaphorm for syscall exec */
     struct semaphore wait_sema;         /* semaphorm of the parent process waiting for the child process finishing */
@@ -125,6 +131,11 @@ struct thread
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
     uint32_t *pagedir;                  /* Page directory. */    
+    struct proc_memstat memstat;        /* Memory statistics. */
+#endif
+#ifdef VM
+    /* Owned by vm/page.c. */
+    struct hash pages;                  /* Supplemental page table. */
 #endif
     
     /* FS code */
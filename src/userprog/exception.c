@@ -2,16 +2,25 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "userprog/pagedir.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 #include "userprog/syscall.h"
+#include "userprog/usercopy.h"
+#ifdef VM
+#include "vm/page.h"
+#endif
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
 
+/* Page faults processed, by cause. */
+static struct fault_stats fault_stats;
+
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
+static void count_fault (struct fault_stats *, bool not_present, bool user);
 
 /* Registers handlers for interrupts that can be caused by user
    programs.
@@ -67,6 +76,19 @@ void
 exception_print_stats (void) 
 {
   printf ("Exception: %lld page faults\n", page_fault_cnt);
+  printf ("Page faults: %lld not present, %lld rights, "
+          "%lld user, %lld kernel\n",
+          fault_stats.not_present, fault_stats.rights,
+          fault_stats.user, fault_stats.kernel);
+}
+
+/* Copies the system-wide page fault counts into STATS. */
+void
+exception_get_stats (struct fault_stats *stats)
+{
+  enum intr_level old_level = intr_disable ();
+  *stats = fault_stats;
+  intr_set_level (old_level);
 }
 
 /* Handler for an exception (probably) caused by a user process. */
@@ -149,6 +171,8 @@ page_fault (struct intr_frame *f)
   not_present = (f->error_code & PF_P) == 0;
   write = (f->error_code & PF_W) != 0;
   user = (f->error_code & PF_U) != 0;
+  count_fault (&fault_stats, not_present, user);
+  count_fault (&thread_current ()->memstat.faults, not_present, user);
 
   /* my code */
   /* if the page fault was caused by user prog, and the fault address 
@@ -156,6 +180,30 @@ page_fault (struct intr_frame *f)
   if ((user)&&(!is_user_vaddr(fault_addr) || fault_addr < USER_VADDR_BASE))
     Err_exit(-1);
 
+#ifdef VM
+  /* Bring in the page if it is part of the process's address
+     space but not resident, or give it a private frame if it is
+     a writable page still mapped to the shared zero page or to a
+     frame shared with another process since fork.  This
+     also covers the kernel touching user memory on the process's
+     behalf. */
+  if ((not_present || write) && page_load (fault_addr, write))
+    return;
+#else
+  /* A write to a page that fork left shared copy-on-write gets a
+     private copy of the page.  This also covers the kernel
+     writing to user memory on the process's behalf. */
+  if (!not_present && write && thread_current ()->pagedir != NULL
+      && pagedir_resolve_cow (thread_current ()->pagedir, fault_addr))
+    return;
+#endif
+
+  /* A kernel fault in one of the user copy routines means that a
+     system call was given a bad pointer.  Make the routine return
+     failure. */
+  if (!user && usercopy_fixup (f))
+    return;
+
   /* To implement virtual memory, delete the rest of the function
      body, and replace it with code that brings in the page to
      which fault_addr refers. */
@@ -167,3 +215,19 @@ page_fault (struct intr_frame *f)
   kill (f);
 }
 
+
+/* Adds a fault with the given cause to STATS. */
+static void
+count_fault (struct fault_stats *stats, bool not_present, bool user)
+{
+  enum intr_level old_level = intr_disable ();
+  if (not_present)
+    stats->not_present++;
+  else
+    stats->rights++;
+  if (user)
+    stats->user++;
+  else
+    stats->kernel++;
+  intr_set_level (old_level);
+}
@@ -1,13 +1,47 @@
 #include "userprog/pagedir.h"
+#include <round.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
 
+/* Copy-on-write.
+
+   pagedir_fork() gives the child every page of the parent by
+   reference instead of copying it.  Both page tables map the
+   page read-only; writable pages are also marked PTE_COW.  The
+   first write by either process faults, and the page fault
+   handler calls pagedir_resolve_cow() to give the writer a
+   private, writable copy.
+
+   A page mapped by more than one page directory has a share
+   count, indexed by physical page number, that holds the number
+   of mappings beyond the first.  A page is freed only when it is
+   unmapped with a share count of 0.  Share counts are protected
+   by disabling interrupts. */
+#define PTE_COW 0x200           /* Copy-on-write (one of PTE_AVL). */
+
+static uint16_t *share_cnt;     /* Extra mappings, by page number. */
+
+/* Number of page tables ever allocated by lookup_page(). */
+static size_t pt_alloc_cnt;
+
 static uint32_t *active_pd (void);
+static uint32_t *lookup_page (uint32_t *, const void *, bool create);
 static void invalidate_pagedir (uint32_t *);
+static void put_page (void *kpage);
+
+/* Allocates the share counts used for copy-on-write. */
+void
+pagedir_init (void)
+{
+  size_t page_cnt = DIV_ROUND_UP (init_ram_pages * sizeof *share_cnt,
+                                  PGSIZE);
+  share_cnt = palloc_get_multiple (PAL_ASSERT | PAL_ZERO, page_cnt);
+}
 
 /* Creates a new page directory that has mappings for kernel
    virtual addresses, but none for user virtual addresses.
@@ -34,25 +68,195 @@ pagedir_destroy (uint32_t *pd)
 
   ASSERT (pd != init_page_dir);
   for (pde = pd; pde < pd + pd_no (PHYS_BASE); pde++)
-    if (*pde & PTE_P) 
+    if ((*pde & (PTE_P | PDE_PS)) == (PTE_P | PDE_PS))
+      palloc_free_multiple (pte_get_page (*pde), LGPGCNT);
+    else if (*pde & PTE_P) 
       {
         uint32_t *pt = pde_get_pt (*pde);
         uint32_t *pte;
         
         for (pte = pt; pte < pt + PGSIZE / sizeof *pte; pte++)
           if (*pte & PTE_P) 
-            palloc_free_page (pte_get_page (*pte));
+            put_page (pte_get_page (*pte));
         palloc_free_page (pt);
       }
   palloc_free_page (pd);
 }
 
+/* Creates a new page directory with the same user mappings as
+   PD, for a child process created by fork.  Large pages are
+   copied.  Other pages are shared copy-on-write; see the comment
+   at the top of this file.  With virtual memory, other pages
+   belong to the supplemental page table, and page_table_copy()
+   shares them copy-on-write through the frame table instead.
+   Returns the new page directory, or a null pointer if memory
+   allocation fails. */
+uint32_t *
+pagedir_fork (uint32_t *pd)
+{
+  uint32_t *child;
+  uint32_t *pde;
+
+  ASSERT (pd != init_page_dir);
+
+  child = pagedir_create ();
+  if (child == NULL)
+    return NULL;
+
+  for (pde = pd; pde < pd + pd_no (PHYS_BASE); pde++)
+    if ((*pde & (PTE_P | PDE_PS)) == (PTE_P | PDE_PS))
+      {
+        void *kpage = palloc_get_aligned (PAL_USER, LGPGCNT, LGPGCNT);
+        if (kpage == NULL)
+          goto error;
+        memcpy (kpage, pte_get_page (*pde), LGSIZE);
+        child[pde - pd] = pde_create_large (kpage, (*pde & PTE_W) != 0);
+      }
+#ifndef VM
+    else if (*pde & PTE_P)
+      {
+        uint32_t *pt = pde_get_pt (*pde);
+        uint32_t *child_pt;
+        enum intr_level old_level;
+        size_t i;
+
+        child_pt = palloc_get_page (PAL_ZERO);
+        if (child_pt == NULL)
+          goto error;
+        child[pde - pd] = pde_create (child_pt);
+
+        old_level = intr_disable ();
+        pt_alloc_cnt++;
+        intr_set_level (old_level);
+
+        for (i = 0; i < PGSIZE / sizeof *pt; i++)
+          if (pt[i] & PTE_P)
+            {
+              if (pt[i] & PTE_W)
+                pt[i] = (pt[i] & ~PTE_W) | PTE_COW;
+              child_pt[i] = pt[i] & ~(PTE_A | PTE_D);
+
+              old_level = intr_disable ();
+              share_cnt[vtop (pte_get_page (pt[i])) >> PGBITS]++;
+              intr_set_level (old_level);
+            }
+      }
+#endif
+  invalidate_pagedir (pd);
+  return child;
+
+ error:
+  invalidate_pagedir (pd);
+  pagedir_destroy (child);
+  return NULL;
+}
+
+/* Gives page directory PD a private, writable copy of the
+   copy-on-write page that contains user virtual address UADDR,
+   or simply makes the page writable if no other page directory
+   maps it any longer.  Returns true if successful, false if
+   UADDR is not in a copy-on-write page or memory is short. */
+bool
+pagedir_resolve_cow (uint32_t *pd, const void *uaddr)
+{
+  enum intr_level old_level;
+  uint32_t *pte;
+  void *kpage, *copy;
+  bool shared;
+
+  if (!is_user_vaddr (uaddr))
+    return false;
+  pte = lookup_page (pd, uaddr, false);
+  if (pte == NULL || (*pte & (PTE_P | PTE_COW)) != (PTE_P | PTE_COW))
+    return false;
+  kpage = pte_get_page (*pte);
+
+  old_level = intr_disable ();
+  shared = share_cnt[vtop (kpage) >> PGBITS] > 0;
+  intr_set_level (old_level);
+
+  if (shared)
+    {
+      /* Copy before letting go of our reference, so that the
+         last sharer cannot start writing the page meanwhile. */
+      copy = palloc_get_page (PAL_USER);
+      if (copy == NULL)
+        return false;
+      memcpy (copy, kpage, PGSIZE);
+      put_page (kpage);
+      *pte = pte_create_user (copy, true);
+    }
+  else
+    *pte = (*pte & ~PTE_COW) | PTE_W;
+  invalidate_pagedir (pd);
+  return true;
+}
+
+/* Drops one mapping of user page KPAGE, freeing the page if it
+   was the last. */
+static void
+put_page (void *kpage)
+{
+  size_t idx = vtop (kpage) >> PGBITS;
+  enum intr_level old_level;
+  bool last;
+
+  old_level = intr_disable ();
+  last = share_cnt[idx] == 0;
+  if (!last)
+    share_cnt[idx]--;
+  intr_set_level (old_level);
+
+  if (last)
+    palloc_free_page (kpage);
+}
+
+/* Returns the number of large pages for user virtual addresses
+   in page directory PD. */
+size_t
+pagedir_large_page_cnt (uint32_t *pd)
+{
+  uint32_t *pde;
+  size_t cnt = 0;
+
+  ASSERT (pd != NULL);
+  for (pde = pd; pde < pd + pd_no (PHYS_BASE); pde++)
+    if ((*pde & (PTE_P | PDE_PS)) == (PTE_P | PDE_PS))
+      cnt++;
+  return cnt;
+}
+
+/* Returns the number of page tables for user virtual addresses
+   in page directory PD. */
+size_t
+pagedir_table_cnt (uint32_t *pd)
+{
+  uint32_t *pde;
+  size_t cnt = 0;
+
+  ASSERT (pd != NULL);
+  for (pde = pd; pde < pd + pd_no (PHYS_BASE); pde++)
+    if ((*pde & (PTE_P | PDE_PS)) == PTE_P)
+      cnt++;
+  return cnt;
+}
+
+/* Returns the number of page tables allocated since boot by all
+   page directories. */
+size_t
+pagedir_tables_allocated (void)
+{
+  return pt_alloc_cnt;
+}
+
 /* Returns the address of the page table entry for virtual
    address VADDR in page directory PD.
    If PD does not have a page table for VADDR, behavior depends
    on CREATE.  If CREATE is true, then a new page table is
    created and a pointer into it is returned.  Otherwise, a null
-   pointer is returned. */
+   pointer is returned.
+   If VADDR is in a large page, returns the PDE that maps it,
+   which has the same format as a PTE. */
 static uint32_t *
 lookup_page (uint32_t *pd, const void *vaddr, bool create)
 {
@@ -70,16 +274,26 @@ lookup_page (uint32_t *pd, const void *vaddr, bool create)
     {
       if (create)
         {
+          enum intr_level old_level;
+
           pt = palloc_get_page (PAL_ZERO);
           if (pt == NULL) 
             return NULL; 
       
           *pde = pde_create (pt);
+
+          old_level = intr_disable ();
+          pt_alloc_cnt++;
+          intr_set_level (old_level);
         }
       else
         return NULL;
     }
 
+  /* A large page has no page table. */
+  if (*pde & PDE_PS)
+    return pde;
+
   /* Return the page table entry. */
   pt = pde_get_pt (*pde);
   return &pt[pt_no (vaddr)];
@@ -118,6 +332,33 @@ pagedir_set_page (uint32_t *pd, void *upage, void *kpage, bool writable)
     return false;
 }
 
+/* Maps the LGSIZE bytes of user virtual memory starting at UPAGE
+   in page directory PD to the large page at kernel virtual
+   address KPAGE, a run of LGPGCNT pages from palloc_get_aligned()
+   aligned on LGSIZE in physical memory.  The whole region must
+   be unmapped and have no page table.  If WRITABLE is true, the
+   region is read/write; otherwise it is read-only.
+   Returns true if successful, false if large pages are not
+   supported or the region is not free. */
+bool
+pagedir_set_large_page (uint32_t *pd, void *upage, void *kpage,
+                        bool writable)
+{
+  uint32_t *pde;
+
+  ASSERT ((uintptr_t) upage % LGSIZE == 0);
+  ASSERT (is_user_vaddr (upage));
+  ASSERT (pd != init_page_dir);
+
+  if (!large_pages_enabled)
+    return false;
+  pde = pd + pd_no (upage);
+  if (*pde != 0)
+    return false;
+  *pde = pde_create_large (kpage, writable);
+  return true;
+}
+
 /* Looks up the physical address that corresponds to user virtual
    address UADDR in PD.  Returns the kernel virtual address
    corresponding to that physical address, or a null pointer if
@@ -131,7 +372,12 @@ pagedir_get_page (uint32_t *pd, const void *uaddr)
   
   pte = lookup_page (pd, uaddr, false);
   if (pte != NULL && (*pte & PTE_P) != 0)
-    return pte_get_page (*pte) + pg_ofs (uaddr);
+    {
+      /* In a large page, the offset spans the whole page. */
+      if (pte == pd + pd_no (uaddr))
+        return pte_get_page (*pte) + ((uintptr_t) uaddr & (LGSIZE - 1));
+      return pte_get_page (*pte) + pg_ofs (uaddr);
+    }
   else
     return NULL;
 }
@@ -139,7 +385,7 @@ pagedir_get_page (uint32_t *pd, const void *uaddr)
 /* Marks user virtual page UPAGE "not present" in page
    directory PD.  Later accesses to the page will fault.  Other
    bits in the page table entry are preserved.
-   UPAGE need not be mapped. */
+   UPAGE need not be mapped, but must not be in a large page. */
 void
 pagedir_clear_page (uint32_t *pd, void *upage) 
 {
@@ -147,6 +393,7 @@ pagedir_clear_page (uint32_t *pd, void *upage)
 
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (is_user_vaddr (upage));
+  ASSERT ((pd[pd_no (upage)] & PDE_PS) == 0);
 
   pte = lookup_page (pd, upage, false);
   if (pte != NULL && (*pte & PTE_P) != 0)
@@ -156,6 +403,31 @@ pagedir_clear_page (uint32_t *pd, void *upage)
     }
 }
 
+/* Returns true if virtual page VPAGE is mapped in PD and may be
+   written by the user process. */
+bool
+pagedir_is_writable (uint32_t *pd, const void *vpage)
+{
+  uint32_t *pte = lookup_page (pd, vpage, false);
+  return pte != NULL && (*pte & (PTE_P | PTE_W)) == (PTE_P | PTE_W);
+}
+
+/* Sets the writable bit to WRITABLE in the PTE for virtual page
+   VPAGE in PD, keeping its accessed and dirty bits. */
+void
+pagedir_set_writable (uint32_t *pd, const void *vpage, bool writable)
+{
+  uint32_t *pte = lookup_page (pd, vpage, false);
+  if (pte != NULL)
+    {
+      if (writable)
+        *pte |= PTE_W;
+      else
+        *pte &= ~(uint32_t) PTE_W;
+      invalidate_pagedir (pd);
+    }
+}
+
 /* Returns true if the PTE for virtual page VPAGE in PD is dirty,
    that is, if the page has been modified since the PTE was
    installed.
@@ -0,0 +1,235 @@
+#include "userprog/pipe.h"
+#include <debug.h>
+#include <poll.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Anonymous pipes.
+
+   A pipe is a one-page ring buffer in the kernel with a read end
+   and a write end, each of which may be open in any number of
+   processes' fd tables.  Readers block while the pipe is empty
+   and writers while it is full.  Once every write end is closed,
+   reads return what is left and then 0 (end of file); once every
+   read end is closed, writes fail.  The pipe is freed when both
+   ends are fully closed.
+
+   Besides the condition variables that blocking readers and
+   writers wait on, each pipe has a wait queue for pollers, which
+   is woken whenever the pipe's readiness may have changed. */
+
+/* Bytes a pipe can hold. */
+#define PIPE_SIZE PGSIZE
+
+struct pipe
+  {
+    struct lock lock;           /* Protects all members. */
+    struct condition not_empty; /* Signaled when data arrives. */
+    struct condition not_full;  /* Signaled when space frees up. */
+    struct wait_queue pollers;  /* Woken on any change. */
+    uint8_t *buffer;            /* PIPE_SIZE bytes of data. */
+    size_t head;                /* Total bytes ever written. */
+    size_t tail;                /* Total bytes ever read. */
+    int readers;                /* Open read ends. */
+    int writers;                /* Open write ends. */
+  };
+
+/* Creates and returns a new, empty pipe with one open read end
+   and one open write end.  Returns a null pointer if memory is
+   short. */
+struct pipe *
+pipe_create (void)
+{
+  struct pipe *p = malloc (sizeof *p);
+  if (p == NULL)
+    return NULL;
+
+  p->buffer = palloc_get_page (0);
+  if (p->buffer == NULL)
+    {
+      free (p);
+      return NULL;
+    }
+  lock_init (&p->lock);
+  cond_init (&p->not_empty);
+  cond_init (&p->not_full);
+  wait_queue_init (&p->pollers);
+  p->head = p->tail = 0;
+  p->readers = p->writers = 1;
+  return p;
+}
+
+/* Opens another reference to the write end of pipe P if
+   WRITE_END is true, or to its read end otherwise, e.g. for an
+   fd inherited by a child process. */
+void
+pipe_open (struct pipe *p, bool write_end)
+{
+  lock_acquire (&p->lock);
+  if (write_end)
+    p->writers++;
+  else
+    p->readers++;
+  lock_release (&p->lock);
+}
+
+/* Closes a reference to the write end of pipe P if WRITE_END is
+   true, or to its read end otherwise.  Wakes up anyone who now
+   sees end of file or a broken pipe, and frees P if both ends are
+   closed. */
+void
+pipe_close (struct pipe *p, bool write_end)
+{
+  bool dead;
+
+  lock_acquire (&p->lock);
+  if (write_end)
+    {
+      ASSERT (p->writers > 0);
+      if (--p->writers == 0)
+        cond_broadcast (&p->not_empty, &p->lock);
+    }
+  else
+    {
+      ASSERT (p->readers > 0);
+      if (--p->readers == 0)
+        cond_broadcast (&p->not_full, &p->lock);
+    }
+  dead = p->readers == 0 && p->writers == 0;
+  wait_queue_wake (&p->pollers);
+  lock_release (&p->lock);
+
+  if (dead)
+    {
+      palloc_free_page (p->buffer);
+      free (p);
+    }
+}
+
+/* Reads up to SIZE bytes from pipe P into BUFFER, waiting until
+   at least one byte is available.  Returns the number of bytes
+   read, which is 0 only at end of file, that is, when P is empty
+   and its write end is closed.  If NONBLOCK is true, returns -1
+   instead of waiting. */
+off_t
+pipe_read (struct pipe *p, void *buffer_, off_t size, bool nonblock)
+{
+  uint8_t *buffer = buffer_;
+  off_t bytes_read = 0;
+
+  if (size <= 0)
+    return 0;
+
+  lock_acquire (&p->lock);
+  while (p->head == p->tail && p->writers > 0)
+    {
+      if (nonblock)
+        {
+          lock_release (&p->lock);
+          return -1;
+        }
+      cond_wait (&p->not_empty, &p->lock);
+    }
+
+  /* Copy out in at most two runs, split where the ring wraps. */
+  while (bytes_read < size && p->tail != p->head)
+    {
+      size_t ofs = p->tail % PIPE_SIZE;
+      size_t chunk = p->head - p->tail;
+
+      if (chunk > PIPE_SIZE - ofs)
+        chunk = PIPE_SIZE - ofs;
+      if (chunk > (size_t) (size - bytes_read))
+        chunk = size - bytes_read;
+      memcpy (buffer + bytes_read, p->buffer + ofs, chunk);
+      p->tail += chunk;
+      bytes_read += chunk;
+    }
+  if (bytes_read > 0)
+    {
+      cond_broadcast (&p->not_full, &p->lock);
+      wait_queue_wake (&p->pollers);
+    }
+  lock_release (&p->lock);
+
+  return bytes_read;
+}
+
+/* Writes SIZE bytes from BUFFER into pipe P, waiting for room as
+   necessary.  Returns the number of bytes written, which is less
+   than SIZE only if every read end of P was closed, or -1 if that
+   happened before anything was written.  If NONBLOCK is true,
+   writes only what fits without waiting, returning -1 if nothing
+   does. */
+off_t
+pipe_write (struct pipe *p, const void *buffer_, off_t size,
+            bool nonblock)
+{
+  const uint8_t *buffer = buffer_;
+  off_t bytes_written = 0;
+
+  if (size <= 0)
+    return 0;
+
+  lock_acquire (&p->lock);
+  while (bytes_written < size && p->readers > 0)
+    {
+      size_t ofs = p->head % PIPE_SIZE;
+      size_t chunk = PIPE_SIZE - (p->head - p->tail);
+
+      if (chunk == 0)
+        {
+          if (nonblock)
+            break;
+          cond_wait (&p->not_full, &p->lock);
+          continue;
+        }
+      if (chunk > PIPE_SIZE - ofs)
+        chunk = PIPE_SIZE - ofs;
+      if (chunk > (size_t) (size - bytes_written))
+        chunk = size - bytes_written;
+      memcpy (p->buffer + ofs, buffer + bytes_written, chunk);
+      p->head += chunk;
+      bytes_written += chunk;
+      cond_broadcast (&p->not_empty, &p->lock);
+      wait_queue_wake (&p->pollers);
+    }
+  lock_release (&p->lock);
+
+  return bytes_written > 0 ? bytes_written : -1;
+}
+
+/* Returns the poll events (see lib/poll.h) that hold for the
+   write end of pipe P if WRITE_END is true, or its read end
+   otherwise.  If E is nonnull, it is also added to the queue of
+   threads that SEMA wakes up when P changes. */
+int
+pipe_poll (struct pipe *p, bool write_end, struct wait_entry *e,
+           struct semaphore *sema)
+{
+  int events = 0;
+
+  lock_acquire (&p->lock);
+  if (e != NULL)
+    wait_queue_add (&p->pollers, e, sema);
+  if (write_end)
+    {
+      if (p->readers == 0)
+        events |= POLLERR;
+      else if (p->head - p->tail < PIPE_SIZE)
+        events |= POLLOUT;
+    }
+  else
+    {
+      if (p->head != p->tail)
+        events |= POLLIN;
+      if (p->writers == 0)
+        events |= POLLIN | POLLHUP;
+    }
+  lock_release (&p->lock);
+
+  return events;
+}
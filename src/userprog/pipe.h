@@ -0,0 +1,19 @@
+#ifndef USERPROG_PIPE_H
+#define USERPROG_PIPE_H
+
+#include <stdbool.h>
+#include "filesys/off_t.h"
+
+struct pipe;
+struct semaphore;
+struct wait_entry;
+
+struct pipe *pipe_create (void);
+void pipe_open (struct pipe *, bool write_end);
+void pipe_close (struct pipe *, bool write_end);
+off_t pipe_read (struct pipe *, void *, off_t size, bool nonblock);
+off_t pipe_write (struct pipe *, const void *, off_t size, bool nonblock);
+int pipe_poll (struct pipe *, bool write_end, struct wait_entry *,
+               struct semaphore *);
+
+#endif /* userprog/pipe.h */
@@ -15,101 +15,275 @@
 #include "threads/init.h"
 #include "threads/interrupt.h"
 #include "threads/palloc.h"
+#include "threads/pte.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 #include "userprog/syscall.h"
 #include "threads/malloc.h"
+#include "threads/slab.h"
+#ifdef VM
+#include "vm/page.h"
+#endif
 
 
 static thread_func start_process NO_RETURN;
-static bool load (const char *cmdline, void (**eip) (void), void **esp);
+static thread_func start_fork NO_RETURN;
+static thread_func reaper NO_RETURN;
+static bool fork_address_space (struct thread *parent);
+static void reap_pending (void);
+static void teardown (struct thread *);
+struct arg_block;
+static bool load (const char *cmdline, struct arg_block *,
+                  void (**eip) (void), void **esp);
+
+/* System-wide memory statistics kept here.  The rest are
+   gathered from their owners by process_get_memstat(). */
+static size_t segment_page_cnt;         /* Pages read from ELF segments. */
+static size_t peak_resident_max;        /* Largest peak of any process. */
+
+/* Exited processes awaiting teardown.
+
+   A process that exits publishes its exit status and wakes up a
+   waiting parent right away, but leaves the slow part of its
+   teardown, freeing its address space and closing its files, to
+   a reaper thread.  The exited thread's struct thread stays
+   allocated until then, because its frames still name it as
+   their owner.  So that exited processes cannot pile up and
+   starve new ones of memory, a process that starts another one
+   first reaps any that are still pending itself.
+
+   Protected by disabling interrupts, because processes are
+   added from the scheduler. */
+static struct list reap_list;
+static struct semaphore reap_sema;      /* Upped per process added. */
+
+/* Starts the reaper. */
+void
+process_init (void)
+{
+  list_init (&reap_list);
+  sema_init (&reap_sema, 0);
+  if (thread_create ("reaper", PRI_DEFAULT, reaper, NULL) == TID_ERROR)
+    PANIC ("cannot start reaper thread");
+}
+
+/* Most pages an argument block can occupy.  A command line is at
+   most a page, including its null terminator, so it has at most
+   PGSIZE / 2 words: one page of strings, a bit over two of argv,
+   part of a third for alignment and the last three words, and one
+   extra page of stack (see build_args()). */
+#define ARG_PAGE_MAX 5
+
+/* The initial stack of a new process: its argument strings,
+   argv[], argv, argc and a null return address, laid out by
+   process_execute() in pages that start_process() installs as
+   the top of the process's stack.  Without VM, these are user
+   pool pages that are mapped directly, so nothing is copied after
+   the command line is parsed.  Under VM, they come from the
+   kernel pool and are copied into frames, so that a full user
+   pool leads to eviction rather than a failed exec. */
+struct arg_block
+  {
+    void *kpages[ARG_PAGE_MAX]; /* Stack pages, highest first;
+                                   each is nulled once mapped. */
+    size_t page_cnt;            /* Number of KPAGES. */
+    void *esp;                  /* Initial user stack pointer. */
+    const char *name;           /* Program name (argv[0]), in KPAGES[0]. */
+  };
+
+/* Pool flags for the pages of an argument block. */
+#ifdef VM
+#define ARG_PAGE_FLAGS PAL_ZERO
+#else
+#define ARG_PAGE_FLAGS (PAL_USER | PAL_ZERO)
+#endif
+
+/* Returns the kernel address of user stack address UADDR in
+   argument block B. */
+static void *
+arg_kaddr (struct arg_block *b, uintptr_t uaddr)
+{
+  size_t idx = ((uintptr_t) PHYS_BASE
+                - (uintptr_t) pg_round_down ((void *) uaddr)) / PGSIZE - 1;
+
+  ASSERT (idx < b->page_cnt);
+  return (uint8_t *) b->kpages[idx] + pg_ofs ((void *) uaddr);
+}
+
+/* Stores VALUE at user stack address UADDR in argument block
+   B. */
+static void
+put_arg_word (struct arg_block *b, uintptr_t uaddr, uint32_t value)
+{
+  *(uint32_t *) arg_kaddr (b, uaddr) = value;
+}
+
+/* Frees the pages of argument block B that have not been
+   mapped. */
+static void
+free_arg_pages (struct arg_block *b)
+{
+  size_t i;
+
+  for (i = 0; i < b->page_cnt; i++)
+    if (b->kpages[i] != NULL)
+      {
+        palloc_free_page (b->kpages[i]);
+        b->kpages[i] = NULL;
+      }
+}
+
+/* Lays out the initial stack for running CMD_LINE in B.  The
+   command line is copied once, to the very top of the stack, and
+   split into words where it lies.  Returns true if successful,
+   false if CMD_LINE is empty or too long or memory is short. */
+static bool
+build_args (struct arg_block *b, const char *cmd_line)
+{
+  size_t len = strlen (cmd_line) + 1;
+  uintptr_t ustrings, uargv;
+  size_t arg_size, page_cnt, i;
+  char *strings, *p;
+  bool in_word = false;
+  int argc = 0;
+
+  memset (b, 0, sizeof *b);
+  if (len > PGSIZE)
+    return false;
+  b->kpages[0] = palloc_get_page (ARG_PAGE_FLAGS);
+  if (b->kpages[0] == NULL)
+    return false;
+  b->page_cnt = 1;
+
+  strings = (char *) b->kpages[0] + PGSIZE - len;
+  memcpy (strings, cmd_line, len);
+  for (p = strings; *p != '\0'; p++)
+    if (*p == ' ')
+      {
+        *p = '\0';
+        in_word = false;
+      }
+    else if (!in_word)
+      {
+        in_word = true;
+        argc++;
+      }
+  if (argc == 0)
+    goto fail;
+
+  /* Below the strings, word-aligned: argv[] with its null
+     terminator, then argv, argc and the return address. */
+  ustrings = (uintptr_t) PHYS_BASE - len;
+  uargv = ROUND_DOWN (ustrings, sizeof (uint32_t))
+          - (argc + 1) * sizeof (uint32_t);
+  b->esp = (void *) (uargv - 3 * sizeof (uint32_t));
+
+  /* An argument block that spills past one page leaves the
+     process little room in the last one, so give it another page
+     of stack. */
+  arg_size = (uintptr_t) PHYS_BASE - (uintptr_t) b->esp;
+  page_cnt = DIV_ROUND_UP (arg_size, PGSIZE) + (arg_size > PGSIZE);
+  ASSERT (page_cnt <= ARG_PAGE_MAX);
+  for (; b->page_cnt < page_cnt; b->page_cnt++)
+    {
+      b->kpages[b->page_cnt] = palloc_get_page (ARG_PAGE_FLAGS);
+      if (b->kpages[b->page_cnt] == NULL)
+        goto fail;
+    }
+
+  i = 0;
+  for (p = strings; p < strings + len - 1; p++)
+    if (*p != '\0' && (p == strings || p[-1] == '\0'))
+      {
+        if (i == 0)
+          b->name = p;
+        put_arg_word (b, uargv + i++ * sizeof (uint32_t),
+                      ustrings + (p - strings));
+      }
+  put_arg_word (b, uargv + argc * sizeof (uint32_t), 0);
+  put_arg_word (b, (uintptr_t) b->esp + 8, uargv);
+  put_arg_word (b, (uintptr_t) b->esp + 4, argc);
+  put_arg_word (b, (uintptr_t) b->esp, 0);
+  return true;
+
+ fail:
+  free_arg_pages (b);
+  return false;
+}
 
 /* Starts a new thread running a user program loaded from
-   FILENAME.  The new thread may be scheduled (and may even exit)
+   FILENAME.  The new process inherits the caller's file
+   descriptors.  The new thread may be scheduled (and may even exit)
    before process_execute() returns.  Returns the new process's
    thread id, or TID_ERROR if the thread cannot be created. */
 tid_t
 process_execute (const char *file_name) 
 {
-  char *fn_copy;
+  struct arg_block *args;
+  struct child_node *cnode;
   tid_t tid;
-  /* my code */
-  char *process_name;
-  char *save_ptr;
-  struct thread *new_t;
-
-  /* Make a copy of FILE_NAME.
-     Otherwise there's a race between the caller and load(). */
-  fn_copy = palloc_get_page (0);
-  if (fn_copy == NULL)
-    return TID_ERROR;
 
-  strlcpy (fn_copy, file_name, PGSIZE);
+  reap_pending ();
 
-  /* my code*/
-  /* copy the file_name to fn_strtok, fn_strtok will be cut off*/
-  char* fn_strtok = malloc(strlen(file_name)+1);
-  if (fn_strtok==NULL)
+  /* Lay out the new process's stack now, so that the caller's
+     FILE_NAME is no longer needed. */
+  args = malloc (sizeof *args);
+  if (args == NULL)
     return TID_ERROR;
-
-  memcpy (fn_strtok, file_name, strlen (file_name) + 1);
-
-  process_name = strtok_r((char *)fn_strtok," ",&save_ptr); // split name
+  if (!build_args (args, file_name))
+    {
+      free (args);
+      return TID_ERROR;
+    }
 
   /* Create a new thread to execute FILE_NAME. */
-  tid = thread_create (process_name, PRI_DEFAULT, start_process, fn_copy);
-
+  tid = thread_create (args->name, PRI_DEFAULT, start_process, args);
   if (tid == TID_ERROR)
-  {
-    palloc_free_page (fn_copy); 
-    free(fn_strtok);
-    return tid;
-  }
+    {
+      free_arg_pages (args);
+      free (args);
+      return tid;
+    }
 
-  /* get the new thread which is to execute file_name */
-  new_t = get_thread(tid);
-  
   /* get the corresponding child_node */
-  struct child_node * cnode = get_child_node(thread_current(),tid);
+  cnode = get_child_node (thread_current (), tid);
 
   /* sema_down at first, to get whether the child process successfully loaded its executable.*/
-  sema_down(&new_t->parent->exec_wait);
-  
+  sema_down (&thread_current ()->exec_wait);
+
   /* if load failed */
   if (cnode->load_success == 0)
     tid = -1;
 
-  free(fn_strtok);
+  free (args);
   return tid;
 }
 
 /* A thread function that loads a user process and starts it
-   running. */
+   running.  ARGS_ is the process's argument block, which the
+   parent frees once we signal it. */
 static void
-start_process (void *file_name_)
+start_process (void *args_)
 {
-  
-  char *file_name = file_name_;
-  
+  struct arg_block *args = args_;
   struct intr_frame if_;
   bool success;
 
-  int *int_p;
-
   /* Initialize interrupt frame and load executable. */
   memset (&if_, 0, sizeof if_);
   if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
   if_.cs = SEL_UCSEG;
   if_.eflags = FLAG_IF | FLAG_MBS;
-  /* my code */
-  char *process_name;
-  char *save_ptr;
-  process_name = strtok_r(file_name," ", &save_ptr);
-  /**/
-  success = load (process_name, &if_.eip, &if_.esp);
+  success = load (args->name, args, &if_.eip, &if_.esp);
 
   struct thread *t=thread_current();
   struct child_node * cnode = get_child_node(t->parent,t->tid);
+
+  /* Inherit the parent's file descriptors, pipes included, except
+     those marked FD_CLOEXEC.  The parent is blocked in
+     process_execute() until we are done. */
+  if (success && !fd_table_copy (t, t->parent, true))
+    success = false;
   
   /* FS code */
   if(!t->cwd){
@@ -118,7 +292,7 @@ start_process (void *file_name_)
 
   /* If load failed, quit. */
   if (!success){ 
-    palloc_free_page (file_name);  // free if load failed
+    free_arg_pages (args);  // free the stack pages that were not mapped
     /* my code */
     /* already know it failed to load */
     if (cnode)
@@ -135,41 +309,6 @@ start_process (void *file_name_)
   sema_up(&t->parent->exec_wait);
   }
 
-  /* setup stack if load success*/
-  char *esp = (char *)if_.esp;
-  char *args[128];  // limit number of arguments
-  int n = 0;
-  // push arguments to stack, no matter order(will be referenced by pointer later)
-  for(char *arg=process_name;arg!=NULL;arg = strtok_r(NULL," ",&save_ptr)){
-    esp -= strlen(arg)+1;  // token+'\0'
-    strlcpy(esp,arg,strlen(arg)+1); 
-    args[n++] = esp;
-  }
-  // 4 word align
-  while((int)esp%4!=0){
-    esp--;
-    *esp = 0;  // data = 0
-  }
-  // store the addr of each auguments
-  int_p = (int *) esp;
-  *--int_p=0;   // argv[4] = 0
-  // store addr of args
-  for(int i=n-1;i>=0;i--){
-    *--int_p = (int *)args[i];
-  }
-  // argv: addr of header of args; type: char**
-  *--int_p = int_p+1;
-  // argc: number of arguments; type: int
-  *--int_p = n;
-  // return addr: 0; type: void(*) ()
-  *--int_p = 0;
-  // stack pointer would be initialized to top of the stack
-  if_.esp = (void *)int_p;
-
-  palloc_free_page (file_name);  // free if load successed and stack has been setted up
-
-  
-
   /* Start the user process by simulating a return from an
      interrupt, implemented by intr_exit (in
      threads/intr-stubs.S).  Because intr_exit takes all of its
@@ -180,6 +319,125 @@ start_process (void *file_name_)
   NOT_REACHED ();
 }
 
+/* Passed from process_fork() to start_fork(). */
+struct fork_args
+  {
+    struct thread *parent;              /* Process being forked. */
+    struct intr_frame if_;              /* Parent's user context. */
+  };
+
+/* Starts a new process that is a copy of the running one, as the
+   Unix fork system call does.  IF_ is the interrupt frame with
+   which the running process entered the kernel.  The child gets
+   a copy of the parent's address space, its own open file for
+   each of the parent's file descriptors, and the parent's working
+   directory, and resumes from IF_ with 0 as the result of the
+   call.  Returns the child's thread id, or TID_ERROR if the
+   child cannot be created. */
+tid_t
+process_fork (const struct intr_frame *if_)
+{
+  struct thread *cur = thread_current ();
+  struct fork_args *args;
+  struct child_node *cnode;
+  tid_t tid;
+
+  reap_pending ();
+  args = malloc (sizeof *args);
+  if (args == NULL)
+    return TID_ERROR;
+  args->parent = cur;
+  args->if_ = *if_;
+
+  tid = thread_create (cur->name, PRI_DEFAULT, start_fork, args);
+  if (tid == TID_ERROR)
+    {
+      free (args);
+      return TID_ERROR;
+    }
+
+  /* Wait until the child has copied everything it needs.  The
+     parent must not run meanwhile, or the copy would not be a
+     snapshot. */
+  cnode = get_child_node (cur, tid);
+  sema_down (&cur->exec_wait);
+  free (args);
+  if (cnode->load_success == 0)
+    return TID_ERROR;
+  return tid;
+}
+
+/* A thread function that makes the running thread a copy of the
+   process in FORK_ARGS_ (a struct fork_args) and starts it
+   running. */
+static void
+start_fork (void *fork_args_)
+{
+  struct fork_args *args = fork_args_;
+  struct thread *t = thread_current ();
+  struct thread *parent = args->parent;
+  struct child_node *cnode = get_child_node (parent, t->tid);
+  struct intr_frame if_ = args->if_;
+
+  if (!fork_address_space (parent) || !fd_table_copy (t, parent, false))
+    {
+      if (cnode)
+        sema_up (&parent->exec_wait);
+      Err_exit (-1);
+    }
+
+  if (t->cwd == NULL)
+    t->cwd = dir_open_root ();
+  if (cnode)
+    {
+      cnode->load_success = 1;
+      sema_up (&parent->exec_wait);
+    }
+
+  /* Return to user mode where the parent left it, but with the
+     child's result from fork. */
+  if_.eax = 0;
+  asm volatile ("movl %0, %%esp; jmp intr_exit" : : "g" (&if_) : "memory");
+  NOT_REACHED ();
+}
+
+/* Gives the running process a copy of PARENT's address space and
+   of its executable.  Returns true if successful. */
+static bool
+fork_address_space (struct thread *parent)
+{
+  struct thread *t = thread_current ();
+
+  t->pagedir = pagedir_fork (parent->pagedir);
+  if (t->pagedir == NULL)
+    return false;
+#ifdef VM
+  if (!page_table_init (&t->pages))
+    {
+      pagedir_destroy (t->pagedir);
+      t->pagedir = NULL;
+      return false;
+    }
+#endif
+  process_activate ();
+
+  if (parent->exec_file != NULL)
+    {
+      t->exec_file = file_reopen (parent->exec_file);
+      if (t->exec_file == NULL)
+        return false;
+      file_deny_write (t->exec_file);
+    }
+
+#ifdef VM
+  process_count_resident (t, LGPGCNT * pagedir_large_page_cnt (t->pagedir));
+  return page_table_copy (parent);
+#else
+  process_count_resident (t, parent->memstat.resident_pages);
+  return true;
+#endif
+}
+
 /* Waits for thread TID to die and returns its exit status.  If
    it was terminated by the kernel (i.e. killed due to an
    exception), returns -1.  If TID is invalid or if it was not a
@@ -225,57 +483,50 @@ process_wait (tid_t child_tid UNUSED)
 
 done:
   list_remove(&cnode->elem);
-  free(cnode);
+  slab_free(child_node_cache, cnode);
   return exit_status;
  
 }
 
-/* Free the current process's resources. */
+/* Closes the current process's files, publishes its exit status
+   and releases what others may be waiting for.  Its address
+   space is left for the reaper; see process_reap(). */
 void
 process_exit (void)
 {
   struct thread *cur = thread_current ();
-  uint32_t *pd;
   struct child_node * cnode;
 
   /* FS code */
   if(cur -> cwd)
+  {
     dir_close(cur->cwd);
+    cur->cwd = NULL;
+  }
 
-  /* Destroy the current process's page directory and switch back
-     to the kernel-only page directory. */
-  pd = cur->pagedir;
-  if (pd != NULL) 
+  if (cur->pagedir != NULL) 
     {
-      /* Correct ordering here is crucial.  We must set
-         cur->pagedir to NULL before switching page directories,
-         so that a timer interrupt can't switch back to the
-         process page directory.  We must activate the base page
-         directory before destroying the process's page
-         directory, or our active page directory will be one
-         that's been freed (and cleared). */
       printf("%s: exit(%d)\n",cur->name,cur->exit_code);
 
 
       /* my code */
+      /* close the executable and the open files now, so that
+         readers of pipes this process wrote see end of file
+         as soon as it exits */
       if (cur->exec_file)
       {
         file_allow_write(cur->exec_file);
         file_close(cur->exec_file);
+        cur->exec_file = NULL;
       }
-      /* free the memory of its file_list*/
-       while(!list_empty(&cur->file_list))
-      {
-        struct file_node *nd = list_entry(list_pop_front(&cur->file_list), struct file_node, elem);
-        if (!nd->isdir)  file_close(nd->file);
-        free(nd);
-      }
+      /* close its open files and free its fd table */
+      CloseFile(cur, 0, true);
 
       /* free the memory of its child_list */
       while(!list_empty(&cur->child_list))
       {
         struct child_node *node = list_entry(list_pop_front(&cur->child_list), struct child_node, elem);
-        free(node);
+        slab_free(child_node_cache, node);
       }
 
       cnode = get_child_node(cur->parent,cur->tid);
@@ -289,12 +540,72 @@ process_exit (void)
       }
 
       /*my code above*/
-      cur->pagedir = NULL;
-      pagedir_activate (NULL);
-      pagedir_destroy (pd);
     }
 }
 
+/* Hands T, a process that has exited and been switched away
+   from for the last time, to the reaper, which tears it down and
+   frees T itself.  Called by the scheduler with interrupts
+   off. */
+void
+process_reap (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->status == THREAD_DYING && t->pagedir != NULL);
+
+  list_push_back (&reap_list, &t->elem);
+  sema_up (&reap_sema);
+}
+
+/* The reaper thread: tears down exited processes as they come. */
+static void
+reaper (void *aux UNUSED)
+{
+  for (;;)
+    {
+      sema_down (&reap_sema);
+      reap_pending ();
+    }
+}
+
+/* Tears down every process on the reap list. */
+static void
+reap_pending (void)
+{
+  for (;;)
+    {
+      enum intr_level old_level;
+      struct thread *t = NULL;
+
+      old_level = intr_disable ();
+      if (!list_empty (&reap_list))
+        t = list_entry (list_pop_front (&reap_list), struct thread, elem);
+      intr_set_level (old_level);
+
+      if (t == NULL)
+        break;
+      teardown (t);
+    }
+}
+
+/* Frees the address space of exited process T and then T
+   itself.  T's page directory is not active: T never runs
+   again, and the running thread has its own. */
+static void
+teardown (struct thread *t)
+{
+  uint32_t *pd = t->pagedir;
+
+  ASSERT (t != thread_current ());
+
+#ifdef VM
+  page_table_destroy (t);
+#endif
+  t->pagedir = NULL;
+  pagedir_destroy (pd);
+  palloc_free_page (t);
+}
+
 /* Sets up the CPU for running user code in the current
    thread.
    This function is called on every context switch. */
@@ -311,6 +622,68 @@ process_activate (void)
   tss_update ();
 }
 
+/* Adjusts the count of T's user pages that are resident in
+   frames by DELTA, which is 1 when a page is mapped to a frame
+   of its own and -1 when it is unmapped. */
+void
+process_count_resident (struct thread *t, int delta)
+{
+  struct proc_memstat *ms = &t->memstat;
+  enum intr_level old_level = intr_disable ();
+
+  ms->resident_pages += delta;
+  if (ms->resident_pages > ms->peak_resident)
+    {
+      ms->peak_resident = ms->resident_pages;
+      if (ms->peak_resident > peak_resident_max)
+        peak_resident_max = ms->peak_resident;
+    }
+  intr_set_level (old_level);
+}
+
+/* Records that a page of an ELF segment was read from the
+   running process's executable. */
+void
+process_count_segment_page (void)
+{
+  enum intr_level old_level = intr_disable ();
+  thread_current ()->memstat.segment_pages++;
+  segment_page_cnt++;
+  intr_set_level (old_level);
+}
+
+/* Fills in MS with memory statistics for the running process
+   and for the system as a whole, except for the system-wide
+   fault counts, which come from exception_get_stats(). */
+void
+process_get_memstat (struct memstat *ms)
+{
+  struct thread *cur = thread_current ();
+  struct sys_memstat *sys = &ms->sys;
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  ms->proc = cur->memstat;
+  sys->segment_pages = segment_page_cnt;
+  intr_set_level (old_level);
+  ms->proc.pt_pages = (cur->pagedir != NULL
+                       ? pagedir_table_cnt (cur->pagedir) : 0);
+
+  palloc_user_stats (&sys->user_pool_size, &sys->user_pool_used,
+                     &sys->user_pool_peak);
+  sys->pt_pages = pagedir_tables_allocated ();
+}
+
+/* Prints user memory statistics. */
+void
+process_print_stats (void)
+{
+  printf ("Process memory: %zu page tables allocated, "
+          "%zu segment pages loaded, peak %zu resident pages\n",
+          pagedir_tables_allocated (), segment_page_cnt,
+          peak_resident_max);
+}
+
 /* We load ELF binaries.  The following definitions are taken
    from the ELF specification, [ELF1], more-or-less verbatim.  */
 
@@ -373,19 +746,23 @@ struct Elf32_Phdr
 #define PF_X 1          /* Executable. */
 #define PF_W 2          /* Writable. */
 #define PF_R 4          /* Readable. */
+#define PF_LARGE 0x00100000  /* Pintos: use large pages (PF_MASKOS bit). */
 
-static bool setup_stack (void **esp);
+static bool setup_stack (struct arg_block *, void **esp);
 static bool validate_segment (const struct Elf32_Phdr *, struct file *);
 static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
                           uint32_t read_bytes, uint32_t zero_bytes,
-                          bool writable);
+                          bool writable, bool large);
+static bool install_large_page (void *upage, bool writable);
 
 /* Loads an ELF executable from FILE_NAME into the current thread.
-   Stores the executable's entry point into *EIP
+   Maps the stack pages of argument block ARGS as the top of its
+   stack.  Stores the executable's entry point into *EIP
    and its initial stack pointer into *ESP.
    Returns true if successful, false otherwise. */
 bool
-load (const char *file_name, void (**eip) (void), void **esp) 
+load (const char *file_name, struct arg_block *args,
+      void (**eip) (void), void **esp) 
 {
   struct thread *t = thread_current ();
   struct Elf32_Ehdr ehdr;
@@ -398,6 +775,14 @@ load (const char *file_name, void (**eip) (void), void **esp)
   t->pagedir = pagedir_create ();
   if (t->pagedir == NULL) 
     goto done;
+#ifdef VM
+  if (!page_table_init (&t->pages))
+    {
+      pagedir_destroy (t->pagedir);
+      t->pagedir = NULL;
+      goto done;
+    }
+#endif
   process_activate ();
 
   /* Open executable file. */
@@ -451,6 +836,7 @@ load (const char *file_name, void (**eip) (void), void **esp)
           if (validate_segment (&phdr, file)) 
             {
               bool writable = (phdr.p_flags & PF_W) != 0;
+              bool large = (phdr.p_flags & PF_LARGE) != 0;
               uint32_t file_page = phdr.p_offset & ~PGMASK;
               uint32_t mem_page = phdr.p_vaddr & ~PGMASK;
               uint32_t page_offset = phdr.p_vaddr & PGMASK;
@@ -471,7 +857,7 @@ load (const char *file_name, void (**eip) (void), void **esp)
                   zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
                 }
               if (!load_segment (file, file_page, (void *) mem_page,
-                                 read_bytes, zero_bytes, writable))
+                                 read_bytes, zero_bytes, writable, large))
                 goto done;
             }
           else
@@ -481,7 +867,7 @@ load (const char *file_name, void (**eip) (void), void **esp)
     }
 
   /* Set up stack. */
-  if (!setup_stack (esp))
+  if (!setup_stack (args, esp))
     goto done;
 
   /* Start address. */
@@ -507,7 +893,9 @@ load (const char *file_name, void (**eip) (void), void **esp)
 
 /* load() helpers. */
 
+#ifndef VM
 static bool install_page (void *upage, void *kpage, bool writable);
+#endif
 
 /* Checks whether PHDR describes a valid, loadable segment in
    FILE and returns true if so, false otherwise. */
@@ -566,19 +954,79 @@ validate_segment (const struct Elf32_Phdr *phdr, struct file *file)
    The pages initialized by this function must be writable by the
    user process if WRITABLE is true, read-only otherwise.
 
+   If LARGE is true, each LGSIZE-aligned run of LGSIZE zero bytes
+   is backed by a large page, if one can be allocated, instead of
+   by LGPGCNT ordinary pages.  Large pages are allocated and
+   zeroed up front and are never evicted.  A program asks for
+   them by setting PF_LARGE in a segment's flags, e.g. with a
+   PHDRS command in its linker script.
+
    Return true if successful, false if a memory allocation error
    or disk read error occurs. */
+#ifdef VM
+/* With virtual memory, nothing is read here.  Each page is
+   entered into the supplemental page table and loaded on its
+   first access. */
+static bool
+load_segment (struct file *file, off_t ofs, uint8_t *upage,
+              uint32_t read_bytes, uint32_t zero_bytes, bool writable,
+              bool large) 
+{
+  ASSERT ((read_bytes + zero_bytes) % PGSIZE == 0);
+  ASSERT (pg_ofs (upage) == 0);
+  ASSERT (ofs % PGSIZE == 0);
+
+  thread_current ()->memstat.segment_cnt++;
+  while (read_bytes > 0 || zero_bytes > 0) 
+    {
+      if (large && read_bytes == 0 && zero_bytes >= LGSIZE
+          && (uintptr_t) upage % LGSIZE == 0
+          && install_large_page (upage, writable))
+        {
+          zero_bytes -= LGSIZE;
+          upage += LGSIZE;
+          continue;
+        }
+
+      size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
+      size_t page_zero_bytes = PGSIZE - page_read_bytes;
+
+      if (page_read_bytes > 0
+          ? !page_add_file (upage, file, ofs, page_read_bytes, writable)
+          : !page_add_zero (upage, writable))
+        return false;
+
+      /* Advance. */
+      read_bytes -= page_read_bytes;
+      zero_bytes -= page_zero_bytes;
+      ofs += page_read_bytes;
+      upage += PGSIZE;
+    }
+  return true;
+}
+#else
 static bool
 load_segment (struct file *file, off_t ofs, uint8_t *upage,
-              uint32_t read_bytes, uint32_t zero_bytes, bool writable) 
+              uint32_t read_bytes, uint32_t zero_bytes, bool writable,
+              bool large) 
 {
   ASSERT ((read_bytes + zero_bytes) % PGSIZE == 0);
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (ofs % PGSIZE == 0);
 
+  thread_current ()->memstat.segment_cnt++;
   file_seek (file, ofs);
   while (read_bytes > 0 || zero_bytes > 0) 
     {
+      if (large && read_bytes == 0 && zero_bytes >= LGSIZE
+          && (uintptr_t) upage % LGSIZE == 0
+          && install_large_page (upage, writable))
+        {
+          zero_bytes -= LGSIZE;
+          upage += LGSIZE;
+          continue;
+        }
+
       /* Calculate how to fill this page.
          We will read PAGE_READ_BYTES bytes from FILE
          and zero the final PAGE_ZERO_BYTES bytes. */
@@ -604,6 +1052,8 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
           palloc_free_page (kpage);
           return false; 
         }
+      if (page_read_bytes > 0)
+        process_count_segment_page ();
 
       /* Advance. */
       read_bytes -= page_read_bytes;
@@ -612,27 +1062,77 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
     }
   return true;
 }
+#endif
 
-/* Create a minimal stack by mapping a zeroed page at the top of
-   user virtual memory. */
+/* Maps a zeroed large page at UPAGE, which must be aligned on
+   LGSIZE, if large pages are enabled and the user pool has a
+   suitably aligned run of free pages.  Returns true if
+   successful. */
 static bool
-setup_stack (void **esp) 
+install_large_page (void *upage, bool writable)
 {
-  uint8_t *kpage;
-  bool success = false;
+  struct thread *t = thread_current ();
+  void *kpage;
 
-  kpage = palloc_get_page (PAL_USER | PAL_ZERO);
-  if (kpage != NULL) 
+  if (!large_pages_enabled)
+    return false;
+  kpage = palloc_get_aligned (PAL_USER | PAL_ZERO, LGPGCNT, LGPGCNT);
+  if (kpage == NULL)
+    return false;
+  if (!pagedir_set_large_page (t->pagedir, upage, kpage, writable))
     {
-      success = install_page (((uint8_t *) PHYS_BASE) - PGSIZE, kpage, true);
-      if (success)
-        *esp = PHYS_BASE;
-      else
-        palloc_free_page (kpage);
+      palloc_free_multiple (kpage, LGPGCNT);
+      return false;
     }
-  return success;
+  process_count_resident (t, LGPGCNT);
+  return true;
+}
+
+/* Creates the stack from the pages of argument block ARGS,
+   already filled in, at the top of user virtual memory, and
+   stores the initial stack pointer in *ESP.  Under VM the pages
+   are copied into frames and freed; otherwise they are mapped
+   directly.  Either way, each page's entry in ARGS is nulled
+   once it is dealt with. */
+#ifdef VM
+static bool
+setup_stack (struct arg_block *args, void **esp) 
+{
+  size_t i;
+
+  for (i = 0; i < args->page_cnt; i++)
+    {
+      uint8_t *upage = (uint8_t *) PHYS_BASE - (i + 1) * PGSIZE;
+      bool success = page_add_copy (upage, args->kpages[i], true);
+
+      palloc_free_page (args->kpages[i]);
+      args->kpages[i] = NULL;
+      if (!success)
+        return false;
+    }
+  *esp = args->esp;
+  return true;
+}
+#else
+static bool
+setup_stack (struct arg_block *args, void **esp) 
+{
+  size_t i;
+
+  for (i = 0; i < args->page_cnt; i++)
+    {
+      uint8_t *upage = (uint8_t *) PHYS_BASE - (i + 1) * PGSIZE;
+
+      if (!install_page (upage, args->kpages[i], true))
+        return false;
+      args->kpages[i] = NULL;
+    }
+  *esp = args->esp;
+  return true;
 }
+#endif
 
+#ifndef VM
 /* Adds a mapping from user virtual address UPAGE to kernel
    virtual address KPAGE to the page table.
    If WRITABLE is true, the user process may modify the page;
@@ -649,7 +1149,10 @@ install_page (void *upage, void *kpage, bool writable)
 
   /* Verify that there's not already a page at that virtual
      address, then map our page there. */
-  return (pagedir_get_page (t->pagedir, upage) == NULL
-          && pagedir_set_page (t->pagedir, upage, kpage, writable));
+  if (pagedir_get_page (t->pagedir, upage) != NULL
+      || !pagedir_set_page (t->pagedir, upage, kpage, writable))
+    return false;
+  process_count_resident (t, 1);
+  return true;
 }
-
+#endif
@@ -1,11 +1,20 @@
 #ifndef USERPROG_PROCESS_H
 #define USERPROG_PROCESS_H
 
+#include <memstat.h>
+#include "threads/interrupt.h"
 #include "threads/thread.h"
 
+void process_init (void);
 tid_t process_execute (const char *file_name);
+tid_t process_fork (const struct intr_frame *);
 int process_wait (tid_t);
 void process_exit (void);
+void process_reap (struct thread *);
 void process_activate (void);
+void process_count_resident (struct thread *, int delta);
+void process_count_segment_page (void);
+void process_get_memstat (struct memstat *);
+void process_print_stats (void);
 
 #endif /* userprog/process.h */
@@ -1,4 +1,5 @@
 #include "userprog/syscall.h"
+#include <console.h>
 #include <stdio.h>
 #include <syscall-nr.h>
 #include "threads/interrupt.h"
@@ -7,178 +8,397 @@
 #include "filesys/file.h"
 #include <stdio.h>
 #include "threads/malloc.h"
+#include "threads/slab.h"
 #include "devices/input.h"
+#include "devices/timer.h"
 #include "threads/vaddr.h"
 #include "userprog/pagedir.h"
+#include "userprog/pipe.h"
+#include "userprog/usercopy.h"
+#include "threads/palloc.h"
 
 #include "userprog/process.h"
+#include "userprog/exception.h"
 #include "devices/shutdown.h"
 #include "threads/synch.h"
 
 #include "filesys/inode.h"
 #include "filesys/directory.h"
+#include <fcntl.h>
+#include <limits.h>
 #include <string.h>
+#ifdef VM
+#include "vm/page.h"
+#endif
+
+/* Number of slots in a process's fd table when it is first
+   allocated.  It doubles each time it fills up. */
+#define FD_TABLE_MIN 16
 
 static void syscall_handler (struct intr_frame *);
 static struct file* getFile(struct thread* t, int fd);
-void CloseFile(struct thread *t, int fd, bool All);
-void is_mapped_vaddr(const void *addr);       /* check whether the user virtual address is valid mapped to the physical address*/
-void is_vbuffer(const void *buffer, unsigned size);  /* check the buffer byte by byte from head to tail */
-void check_vaddr (const void *ptr);         /* check whether the address is valid user virtual address */
-void check_each_byte(const void* pointer);  /* check four bytes related to a pointer */
-void check_string(const void* pointer);  /* check the string byte by byte from head to tail */
+static int fd_install (struct thread *t, struct file_node *node);  /* put a file_node at the lowest free fd */
+static bool pin_buffer (const void *buffer, unsigned size, bool write);  /* check the buffer page by page and pin it */
+static void unpin_buffer (const void *buffer, unsigned size);  /* release a buffer pinned by pin_buffer() */
+
+/* How the system call dispatcher treats an argument. */
+enum arg_kind
+  {
+    ARG_INT,            /* Integer, fd, pid, or size: passed as is. */
+    ARG_STRING,         /* User string, copied into the kernel. */
+    ARG_BUF_IN,         /* User buffer the kernel reads from. */
+    ARG_BUF_OUT         /* User buffer the kernel writes to. */
+  };
+
+/* Maximum number of arguments to a system call. */
+#define SYSCALL_MAX_ARGS 4
+
+/* A system call handler.  ARGS holds the call's arguments, which
+   the dispatcher has already validated according to the call's
+   descriptor.  Returns the value for the caller's eax. */
+typedef uint32_t syscall_func (const uint32_t args[]);
+
+/* Describes a system call. */
+struct syscall_desc
+  {
+    syscall_func *func;                 /* Handler. */
+    int arg_cnt;                        /* Number of arguments. */
+    enum arg_kind kinds[SYSCALL_MAX_ARGS];  /* Kind of each argument. */
+    size_t buf_size;                    /* Size of an ARG_BUF_* argument,
+                                           or 0 if it is the next one. */
+  };
+
+static syscall_func sys_halt, sys_exit, sys_exec, sys_wait, sys_create,
+  sys_remove, sys_open, sys_filesize, sys_read, sys_write, sys_seek,
+  sys_tell, sys_close, sys_chdir, sys_mkdir, sys_readdir, sys_isdir,
+  sys_inumber, sys_memstat, sys_readv, sys_writev, sys_pread, sys_pwrite,
+  sys_fork, sys_pipe, sys_fcntl, sys_poll;
+
+/* System calls, indexed by number.  Calls without a handler
+   (mmap and munmap) fail with -1.  To add a system call, give it
+   a number in lib/syscall-nr.h and an entry here. */
+static const struct syscall_desc syscall_table[] =
+  {
+    [SYS_HALT] =     {sys_halt, 0, {0}, 0},
+    [SYS_EXIT] =     {sys_exit, 1, {ARG_INT}, 0},
+    [SYS_EXEC] =     {sys_exec, 1, {ARG_STRING}, 0},
+    [SYS_WAIT] =     {sys_wait, 1, {ARG_INT}, 0},
+    [SYS_CREATE] =   {sys_create, 2, {ARG_STRING, ARG_INT}, 0},
+    [SYS_REMOVE] =   {sys_remove, 1, {ARG_STRING}, 0},
+    [SYS_OPEN] =     {sys_open, 1, {ARG_STRING}, 0},
+    [SYS_FILESIZE] = {sys_filesize, 1, {ARG_INT}, 0},
+    [SYS_READ] =     {sys_read, 3, {ARG_INT, ARG_BUF_OUT, ARG_INT}, 0},
+    [SYS_WRITE] =    {sys_write, 3, {ARG_INT, ARG_BUF_IN, ARG_INT}, 0},
+    [SYS_SEEK] =     {sys_seek, 2, {ARG_INT, ARG_INT}, 0},
+    [SYS_TELL] =     {sys_tell, 1, {ARG_INT}, 0},
+    [SYS_CLOSE] =    {sys_close, 1, {ARG_INT}, 0},
+    [SYS_MMAP] =     {NULL, 2, {ARG_INT, ARG_INT}, 0},
+    [SYS_MUNMAP] =   {NULL, 1, {ARG_INT}, 0},
+    [SYS_CHDIR] =    {sys_chdir, 1, {ARG_STRING}, 0},
+    [SYS_MKDIR] =    {sys_mkdir, 1, {ARG_STRING}, 0},
+    [SYS_READDIR] =  {sys_readdir, 2, {ARG_INT, ARG_BUF_OUT}, NAME_MAX + 1},
+    [SYS_ISDIR] =    {sys_isdir, 1, {ARG_INT}, 0},
+    [SYS_INUMBER] =  {sys_inumber, 1, {ARG_INT}, 0},
+    [SYS_MEMSTAT] =  {sys_memstat, 1, {ARG_INT}, 0},
+    [SYS_READV] =    {sys_readv, 3, {ARG_INT, ARG_INT, ARG_INT}, 0},
+    [SYS_WRITEV] =   {sys_writev, 3, {ARG_INT, ARG_INT, ARG_INT}, 0},
+    [SYS_PREAD] =    {sys_pread, 4, {ARG_INT, ARG_BUF_OUT, ARG_INT, ARG_INT}, 0},
+    [SYS_PWRITE] =   {sys_pwrite, 4, {ARG_INT, ARG_BUF_IN, ARG_INT, ARG_INT}, 0},
+    [SYS_FORK] =     {sys_fork, 0, {0}, 0},
+    [SYS_PIPE] =     {sys_pipe, 1, {ARG_BUF_OUT}, 2 * sizeof (int)},
+    [SYS_FCNTL] =    {sys_fcntl, 3, {ARG_INT, ARG_INT, ARG_INT}, 0},
+    [SYS_POLL] =     {sys_poll, 3, {ARG_INT, ARG_INT, ARG_INT}, 0},
+  };
+
+/* Number of entries in syscall_table. */
+#define SYSCALL_CNT (sizeof syscall_table / sizeof *syscall_table)
+
+/* Cache of file descriptor table entries. */
+static struct slab_cache *file_node_cache;
 
 void
 syscall_init (void) 
 {
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
+  file_node_cache = slab_create ("file_node", sizeof (struct file_node),
+                                 NULL);
+}
+
+// allocate a file_node with every field cleared, or NULL if memory is short
+static struct file_node *
+new_node (void)
+{
+  struct file_node *node = slab_alloc(file_node_cache);
+  if (node != NULL)
+    memset(node, 0, sizeof *node);
+  return node;
+}
+
+static bool get_arg (const struct syscall_desc *, uint32_t args[], int i);
+static void put_args (const struct syscall_desc *, uint32_t args[], int cnt);
+
+/* Returns the size of buffer argument I of a call described by
+   D with arguments ARGS. */
+static size_t
+buf_arg_size (const struct syscall_desc *d, const uint32_t args[], int i)
+{
+  return d->buf_size != 0 ? d->buf_size : args[i + 1];
 }
 
 static void
-syscall_handler (struct intr_frame *f UNUSED) 
+syscall_handler (struct intr_frame *f) 
 { 
-  // terminate process with exit code -1 if esp was setted to bad addr
-  if(!f || !(f->esp)){  // check if ponter is NULL
-    Err_exit(-1);
-  }
+  const uint32_t *esp = f->esp;
+  const struct syscall_desc *d;
+  uint32_t args[SYSCALL_MAX_ARGS];
+  unsigned syscall_num;
+  int i;
 
-  /* check validity of pointers and whether the pointer is valid mapped */
-  check_each_byte((int *)f->esp);
-  check_each_byte(((int *)f->esp)+1);
-  check_each_byte(((int *)f->esp)+2);
-  check_each_byte(((int *)f->esp)+3);
+  /* Fetch the system call number and its arguments.  A bad stack
+     pointer makes the copy fail rather than fault. */
+  if (!copy_from_user (&syscall_num, esp, sizeof syscall_num)
+      || syscall_num >= SYSCALL_CNT)
+    Err_exit(-1);
+  d = &syscall_table[syscall_num];
+  if (!copy_from_user (args, esp + 1, d->arg_cnt * sizeof *args))
+    Err_exit(-1);
 
-  int syscall_num = *(int *)f->esp;
-  
-  if(syscall_num <0 || syscall_num > 20 ){
-    Err_exit(-1);  
-  }
-  switch(syscall_num)
-  {
-    case SYS_HALT:
-    {
-      Sys_halt();
-      break;
-    }
-    case SYS_EXIT:
-    {
-      int status = *((int*)f->esp+1);
-      Sys_exit(status);
-      break;
-    }
-    case SYS_EXEC:
+  if (d->func == NULL)
     {
-      const char* cmd_line = (char *)*((int*)f->esp+1);
-      check_string(cmd_line);
-      f->eax = Sys_exec(cmd_line);
-      break;
-    }
-    case SYS_WAIT:
-    {
-      pid_t pid =  *((int*)f->esp+1);
-      f->eax = Sys_wait(pid);
-      break;
-    }
-    case SYS_CREATE:
-    {
-      const char*file =(char *) *((int*)f->esp+1);
-      is_mapped_vaddr(file);
-      unsigned initial_size =  *((int*)f->esp+2);
-      f->eax = Sys_create(file,initial_size);
-      break;
-    }
-    case SYS_REMOVE:
-    {
-      const char* file = (char *) *((int*)f->esp+1);
-      is_mapped_vaddr(file);
-      f->eax = Sys_remove(file);
-      break;
-    }
-    case SYS_OPEN:
-    {
-      const char* file = (char *)*((int*)f->esp+1);
-      is_mapped_vaddr(file);
-      f->eax = Sys_open(file);
-      break;
-    }
-    case SYS_FILESIZE:
-    {
-      int fd =  *((int*)f->esp+1);
-      f->eax = Sys_filesize(fd);
-      break;
-    }
-    case SYS_READ:
-    {
-      int fd = *((int*)f->esp+1);
-      void* buffer = (void *)*((int*)f->esp+2);
-      unsigned size= *((int*)f->esp+3);
-      is_vbuffer(buffer,size);
-      f->eax = Sys_read(fd, buffer, size);
-      break;
-    }
-    case SYS_WRITE:
-    {
-      int fd = *((int*)f->esp+1);
-      const void* buffer = (void *)*((int *)f->esp+2);
-      unsigned size = *((int *)f->esp+3);
-      is_vbuffer(buffer,size);
-      f->eax = Sys_write(fd,buffer,size);
-      break;
-    }
-    case SYS_SEEK:
-    {
-      int fd = *((int*)f->esp+1);
-      unsigned position = *((int*)f->esp+2);
-      Sys_seek(fd, position);
-      break;
-    }
-    case SYS_TELL:
-    {  
-      int fd = *((int*)f->esp+1);
-      f->eax = Sys_tell(fd);
-      break;
-    }
-    case SYS_CLOSE:
-    { 
-      int fd = *((int*)f->esp+1);
-      Sys_close(fd);
-      break;
-    }
-    case SYS_CHDIR:
-    {
-      const char* dir = (char *)*((int*)f->esp+1);
-      is_mapped_vaddr(dir);
-      f->eax = Sys_chdir(dir);
-      break;
-    }
-    case SYS_MKDIR:
-    {
-      const char* dir = (char *)*((int*)f->esp+1);
-      is_mapped_vaddr(dir);
-      f->eax = Sys_mkdir (dir);
-      break;
-    }
-    case SYS_READDIR:
-    {
-      int fd = *((int*)f->esp+1);
-      char* name = (char *)*((int*)f->esp+2);
-      check_string(name);
-      f->eax = Sys_readdir(fd, name);
-      break;
-    }
-    case SYS_ISDIR:
-    {
-      int fd = *((int*)f->esp+1);
-      f->eax = Sys_isdir(fd);
-      break;
+      f->eax = -1;
+      return;
     }
-    case SYS_INUMBER:
+
+  /* Copy strings into the kernel and pin buffers for the call. */
+  for (i = 0; i < d->arg_cnt; i++)
+    if (!get_arg (d, args, i))
+      {
+        put_args (d, args, i);
+        Err_exit(-1);
+      }
+
+  f->eax = d->func (args);
+
+  put_args (d, args, d->arg_cnt);
+}
+
+/* Prepares argument I of a call described by D with arguments
+   ARGS.  A string is copied into a kernel page, and ARGS[I] is
+   replaced by the copy.  A buffer is pinned.  Returns true if
+   successful, false if the argument is a bad pointer. */
+static bool
+get_arg (const struct syscall_desc *d, uint32_t args[], int i)
+{
+  char *kstr;
+
+  switch (d->kinds[i])
     {
-      int fd = *((int*)f->esp+1);
-      f->eax = Sys_inumber(fd);
-      break;
+    case ARG_INT:
+      return true;
+
+    case ARG_STRING:
+      kstr = palloc_get_page (0);
+      if (kstr == NULL)
+        return false;
+      if (copy_string_from_user (kstr, (const char *) args[i], PGSIZE) < 0)
+        {
+          palloc_free_page (kstr);
+          return false;
+        }
+      args[i] = (uint32_t) kstr;
+      return true;
+
+    case ARG_BUF_IN:
+    case ARG_BUF_OUT:
+      return pin_buffer ((const void *) args[i], buf_arg_size (d, args, i),
+                         d->kinds[i] == ARG_BUF_OUT);
     }
-  }
+  NOT_REACHED ();
+}
+
+/* Releases the first CNT arguments of a call described by D with
+   arguments ARGS, prepared by get_arg(). */
+static void
+put_args (const struct syscall_desc *d, uint32_t args[], int cnt)
+{
+  int i;
+
+  for (i = 0; i < cnt; i++)
+    if (d->kinds[i] == ARG_STRING)
+      palloc_free_page ((void *) args[i]);
+    else if (d->kinds[i] != ARG_INT)
+      unpin_buffer ((const void *) args[i], buf_arg_size (d, args, i));
+}
+
+/* Handlers for syscall_table, which unpack the arguments and call
+   the corresponding Sys_* functions. */
+
+static uint32_t
+sys_halt (const uint32_t args[] UNUSED)
+{
+  Sys_halt();
+  NOT_REACHED ();
+}
+
+static uint32_t
+sys_exit (const uint32_t args[])
+{
+  Sys_exit((int) args[0]);
+  NOT_REACHED ();
+}
+
+static uint32_t
+sys_exec (const uint32_t args[])
+{
+  return Sys_exec((const char *) args[0]);
+}
+
+static uint32_t
+sys_wait (const uint32_t args[])
+{
+  return Sys_wait((pid_t) args[0]);
+}
+
+static uint32_t
+sys_create (const uint32_t args[])
+{
+  return Sys_create((const char *) args[0], args[1]);
+}
+
+static uint32_t
+sys_remove (const uint32_t args[])
+{
+  return Sys_remove((const char *) args[0]);
+}
+
+static uint32_t
+sys_open (const uint32_t args[])
+{
+  return Sys_open((const char *) args[0]);
+}
+
+static uint32_t
+sys_filesize (const uint32_t args[])
+{
+  return Sys_filesize((int) args[0]);
+}
+
+static uint32_t
+sys_read (const uint32_t args[])
+{
+  return Sys_read((int) args[0], (void *) args[1], args[2]);
+}
+
+static uint32_t
+sys_write (const uint32_t args[])
+{
+  return Sys_write((int) args[0], (const void *) args[1], args[2]);
+}
+
+static uint32_t
+sys_seek (const uint32_t args[])
+{
+  Sys_seek((int) args[0], args[1]);
+  return 0;
+}
+
+static uint32_t
+sys_tell (const uint32_t args[])
+{
+  return Sys_tell((int) args[0]);
+}
+
+static uint32_t
+sys_close (const uint32_t args[])
+{
+  Sys_close((int) args[0]);
+  return 0;
+}
+
+static uint32_t
+sys_chdir (const uint32_t args[])
+{
+  return Sys_chdir((const char *) args[0]);
+}
+
+static uint32_t
+sys_mkdir (const uint32_t args[])
+{
+  return Sys_mkdir((const char *) args[0]);
+}
+
+static uint32_t
+sys_readdir (const uint32_t args[])
+{
+  return Sys_readdir((int) args[0], (char *) args[1]);
+}
+
+static uint32_t
+sys_isdir (const uint32_t args[])
+{
+  return Sys_isdir((int) args[0]);
+}
+
+static uint32_t
+sys_inumber (const uint32_t args[])
+{
+  return Sys_inumber((int) args[0]);
+}
+
+static uint32_t
+sys_memstat (const uint32_t args[])
+{
+  return Sys_memstat((struct memstat *) args[0]);
+}
+
+static uint32_t
+sys_readv (const uint32_t args[])
+{
+  return Sys_readv((int) args[0], (const struct iovec *) args[1],
+                   (int) args[2]);
+}
+
+static uint32_t
+sys_writev (const uint32_t args[])
+{
+  return Sys_writev((int) args[0], (const struct iovec *) args[1],
+                    (int) args[2]);
+}
+
+static uint32_t
+sys_pread (const uint32_t args[])
+{
+  return Sys_pread((int) args[0], (void *) args[1], args[2], args[3]);
+}
+
+static uint32_t
+sys_pwrite (const uint32_t args[])
+{
+  return Sys_pwrite((int) args[0], (const void *) args[1], args[2], args[3]);
+}
+
+static uint32_t
+sys_fork (const uint32_t args[] UNUSED)
+{
+  return Sys_fork();
+}
+
+static uint32_t
+sys_pipe (const uint32_t args[])
+{
+  return Sys_pipe((int *) args[0]);
+}
+
+static uint32_t
+sys_fcntl (const uint32_t args[])
+{
+  return Sys_fcntl((int) args[0], (int) args[1], (int) args[2]);
+}
+
+static uint32_t
+sys_poll (const uint32_t args[])
+{
+  return Sys_poll((struct pollfd *) args[0], (int) args[1], (int) args[2]);
 }
 
 void
@@ -208,6 +428,19 @@ Sys_exec(const char* cmd_line)
   return pid;
 }
 
+/* Creates a copy of the calling process.  The parent gets the
+   child's pid, or -1 on failure; the child gets 0. */
+pid_t
+Sys_fork(void)
+{
+  /* A process enters the kernel on the stack that the TSS points
+     to, the top of its thread's page, so that is where the
+     interrupt frame with its user context lies. */
+  struct intr_frame *f = (struct intr_frame *)
+    ((uint8_t *) thread_current() + PGSIZE) - 1;
+  return process_fork(f);
+}
+
 int
 Sys_wait(pid_t pid)
 {
@@ -232,26 +465,36 @@ int
 Sys_open(const char*file)
 {
   struct file *f = filesys_open(file);
+  struct dir *d = NULL;
   struct thread *t = thread_current();
   // return -1 if open file fail
   if(!f)
     return -1;
-  // add file to process file_list and change file discriptor
-  struct file_node *node = malloc(sizeof(struct file_node));
+  bool isdir = inode_is_dir(file_get_inode(f));
+  // directories come back as files; reopen them as dirs
+  if (isdir){
+    d = dir_open(inode_reopen(file_get_inode(f)));
+    file_close(f);
+    if (!d)
+      return -1;
+  }
+  // add file to process fd table, at the lowest free file discriptor
+  struct file_node *node = new_node();
   // have to do free operation later, or it will occur mem leak
+  if (node == NULL || fd_install(t, node) < 0){
+    slab_free(file_node_cache, node);
+    if (isdir) dir_close(d);
+    else file_close(f);
+    return -1;
+  }
   
-  if (inode_is_dir(file_get_inode(f))){
-    node -> dir = (struct dir *)f;
+  if (isdir){
+    node -> dir = d;
     node -> isdir = true;
   }else{
     node -> file = f;
     node -> isdir = false;
   }
-
-  node->fd = t->fd;
-  t->fd++;
-  // push node into thread's file_list
-  list_push_back(&t->file_list, &node->elem);
   return node->fd;  // return a nonnegative int called "file discriptor"
 }
 int
@@ -268,7 +511,19 @@ Sys_read(int fd, void *buffer, unsigned length)
   if(fd==STDOUT_FILENO)
     Err_exit(-1);
   uint8_t *buf = (uint8_t *)buffer;
+  struct file_node *node = get_file_node(fd);
+  if(node && node->pipe){  // read from the read end of a pipe
+    if(node->pipe_write)
+      return -1;
+    return pipe_read(node->pipe, buffer, length, node->nonblock);
+  }
   if(fd==STDIN_FILENO){  // read from STDIN
+    if(thread_current()->stdin_nonblock){  // only the keys already typed
+      unsigned i = 0;
+      while(i < length && input_poll(NULL, NULL))
+        buf[i++] = input_getc();
+      return i > 0 || length == 0 ? (int) i : -1;
+    }
     for(unsigned i=0;i<length;i++){
       buf[i] = input_getc();
     }
@@ -310,68 +565,162 @@ int
 Sys_write(int fd, const void *buffer, unsigned size)
 {
    if(fd==STDOUT_FILENO){
-    putbuf(buffer, size);
+    console_write_nonblocking(buffer, size);
     return size;
   }
-  struct thread *t = thread_current();
-  struct file *f = getFile(t,fd);   // get the file of current process
-  
-  struct file_node *node = get_file_node(fd);
+  struct file_node *node = get_file_node(fd);   // get the file of current process
   
   int bytes = 0;
-  if(f==NULL){
+  if(node==NULL){
     Err_exit(-1);   // return 0 if no bytes could be written at all
   }
   if (node -> isdir) return -1;
-  bytes = file_write(f,buffer,size);
+  if (node -> pipe)
+    return node->pipe_write ? pipe_write(node->pipe, buffer, size, node->nonblock) : -1;
+  bytes = file_write(node->file,buffer,size);
   return bytes;
 
 }
 
+// return the file of fd in T's fd table, or NULL if fd is not an open file
 struct file* getFile(struct thread* t, int fd)
 {
-  struct list_elem *e;
-  for (e = list_begin(&t->file_list);e!=list_end(&t->file_list);e=list_next(e)){
-    struct file_node *node = list_entry(e,struct file_node, elem);
-    if(node->fd==fd){
-      return node->file;
+  if(fd < 0 || fd >= t->fd_cnt)
+    return NULL;
+  struct file_node *node = t->fd_table[fd];
+  if(!node || node->isdir)
+    return NULL;
+  return node->file;
+}
+
+/* Puts NODE into T's fd table at the lowest free fd, growing the
+   table if it is full, and sets NODE->fd.  Returns the fd, or -1
+   if memory is short. */
+static int
+fd_install (struct thread *t, struct file_node *node)
+{
+  int fd;
+
+  for (fd = t->fd_next; fd < t->fd_cnt; fd++)
+    if (t->fd_table[fd] == NULL)
+      break;
+  if (fd == t->fd_cnt)
+    {
+      int new_cnt = t->fd_cnt > 0 ? t->fd_cnt * 2 : FD_TABLE_MIN;
+      struct file_node **new_table;
+
+      new_table = realloc (t->fd_table, new_cnt * sizeof *new_table);
+      if (new_table == NULL)
+        return -1;
+      memset (new_table + t->fd_cnt, 0,
+              (new_cnt - t->fd_cnt) * sizeof *new_table);
+      t->fd_table = new_table;
+      t->fd_cnt = new_cnt;
     }
+
+  t->fd_table[fd] = node;
+  t->fd_next = fd + 1;
+  node->fd = fd;
+  return fd;
+}
+
+// close the file, dir or pipe end of NODE and free it
+static void
+close_node (struct file_node *node)
+{
+  if (node -> pipe){
+    pipe_close(node->pipe, node->pipe_write);
+  }else if (node -> isdir){
+    dir_close(node->dir);
+  }else{
+    file_close(node->file);
   }
-  return NULL;
+  slab_free(file_node_cache, node);
+}
+
+/* Gives DST, a new process forked from SRC, or exec'd by SRC if
+   EXEC is true, an fd table with the same fds as SRC's, less
+   those marked FD_CLOEXEC in the exec case.  Each fd gets its own
+   open file or directory for the same inode; a file's position is
+   copied, but from then on the two move independently.  Returns
+   true if successful. */
+bool
+fd_table_copy(struct thread *dst, struct thread *src, bool exec)
+{
+  ASSERT(dst->fd_table == NULL);
+  dst->stdin_nonblock = src->stdin_nonblock;
+  if (src->fd_cnt == 0)
+    return true;
+
+  dst->fd_table = calloc(src->fd_cnt, sizeof *dst->fd_table);
+  if (dst->fd_table == NULL)
+    return false;
+  dst->fd_cnt = src->fd_cnt;
+  dst->fd_next = src->fd_next;
+
+  for (int i = 0; i < src->fd_cnt; i++)
+    {
+      struct file_node *old = src->fd_table[i];
+      struct file_node *node;
+
+      if (old == NULL)
+        continue;
+      if (exec && old->cloexec)
+        {
+          if (i < dst->fd_next)
+            dst->fd_next = i;   // leave the hole for fd_install
+          continue;
+        }
+      node = new_node();
+      if (node == NULL)
+        return false;
+      node->fd = i;
+      node->isdir = old->isdir;
+      node->pipe_write = old->pipe_write;
+      node->nonblock = old->nonblock;
+      node->cloexec = old->cloexec;
+      if (old->pipe)
+        {
+          node->pipe = old->pipe;
+          pipe_open(node->pipe, node->pipe_write);
+        }
+      else if (old->isdir)
+        node->dir = dir_reopen(old->dir);
+      else
+        {
+          node->file = file_reopen(old->file);
+          if (node->file != NULL)
+            file_seek(node->file, file_tell(old->file));
+        }
+      if (node->pipe == NULL && node->dir == NULL && node->file == NULL)
+        {
+          slab_free(file_node_cache, node);
+          return false;
+        }
+      dst->fd_table[i] = node;
+    }
+  return true;
 }
 
 // have to call this func whit All == true when process exit
 void CloseFile(struct thread *t, int fd, bool All)
 {
   if(All){
-    while(!list_empty(&t->file_list)){
-      struct file_node *node = list_entry(list_pop_front(&t->file_list), struct file_node,
-            elem);
-      if (node -> isdir){
-        dir_close(node->dir);
-      }else{
-        file_close(node->file);
-      }
-      list_remove(&node->elem);
-      free(node);
-    }
+    for (int i = 0; i < t->fd_cnt; i++)
+      if (t->fd_table[i])
+        close_node(t->fd_table[i]);
+    free(t->fd_table);
+    t->fd_table = NULL;
+    t->fd_cnt = 0;
+    t->fd_next = 2;
     return;
   }
-  for (struct list_elem *e=list_begin(&t->file_list);e!=list_end(&t->file_list);
-       e = list_next(e)){
-    struct file_node *node = list_entry(e, struct file_node, elem);
-    if(node->fd==fd){
-      if (node -> isdir){
-        dir_close(node->dir);
-      }else{
-        file_close(node->file);
-      }
-      list_remove(e);
-      free(node);
-      return;
-    }
-
-  }
+  if (fd < 0 || fd >= t->fd_cnt || !t->fd_table[fd])
+    return;
+  close_node(t->fd_table[fd]);
+  t->fd_table[fd] = NULL;
+  if (fd < t->fd_next)
+    t->fd_next = fd;   // reuse the lowest free fd first
 }
 void
 Err_exit(int status)
@@ -381,55 +730,73 @@ Err_exit(int status)
   thread_exit();
 }
 
-void check_vaddr (const void *ptr)
+/* Makes sure that user page UPAGE is mapped, and writable if
+   WRITE is true, and that it stays resident until unpin_page()
+   is called.  Returns true if successful. */
+static bool
+pin_page (const void *upage, bool write)
 {
-  if(!is_user_vaddr(ptr) || ptr < USER_VADDR_BASE)
-    Err_exit(-1);
-}
+  uint8_t byte;
 
-void is_mapped_vaddr(const void *addr)
-{
-  if (is_user_vaddr(addr))
-  {
-    void *ptr = pagedir_get_page(thread_current()->pagedir, addr);
-    if(!ptr)
-      Err_exit(-1);
-  }
+#ifdef VM
+  if (page_pin (upage, write))
+    return true;
+#endif
+  /* Other pages, such as large pages, are always resident, so it
+     is enough to touch the page: a bad one makes the access fail
+     instead of faulting. */
+  return (get_user (&byte, upage)
+          && (!write || put_user ((uint8_t *) upage, byte)));
 }
 
-void is_vbuffer(const void *buffer, unsigned size)
+/* Releases user page UPAGE, pinned by pin_page(). */
+static void
+unpin_page (const void *upage UNUSED)
 {
-  char *buf = (char *) buffer;
-  for(unsigned i=0;i<size;i++)
-  {
-    check_vaddr((const void *) buf);
-    is_mapped_vaddr(buf);
-    buf++;
-  }
+#ifdef VM
+  page_unpin (upage);
+#endif
 }
 
-void check_each_byte(const void* pointer)
+/* Makes sure that the SIZE bytes at BUFFER are valid user
+   memory, writable if WRITE is true, and pins the pages that
+   hold them, so that the kernel (and the disk) can access the
+   buffer without faulting.  Each page is touched once.  Returns
+   true if successful, false if any page is bad.  On success, the
+   caller must call unpin_buffer() when it is done. */
+static bool
+pin_buffer (const void *buffer, unsigned size, bool write)
 {
-  unsigned char* pt = (unsigned char*) pointer;
-  for (int i=0;i<4;i++)
-  {
-    check_vaddr((const void*) pt);
-    is_mapped_vaddr((const void*) pt);
-    pt++;
-  }
+  const uint8_t *start = buffer;
+  const uint8_t *end = start + size;
+  const uint8_t *upage;
+
+  if (size == 0)
+    return true;
+  if (end < start || !is_user_vaddr (end - 1))
+    return false;
+
+  for (upage = pg_round_down (start); upage < end; upage += PGSIZE)
+    if (!pin_page (upage, write))
+      {
+        unpin_buffer (start, upage - start);
+        return false;
+      }
+  return true;
 }
 
-void check_string(const void* pointer)
+/* Unpins the SIZE bytes at BUFFER, pinned by pin_buffer(). */
+static void
+unpin_buffer (const void *buffer, unsigned size)
 {
-  char* pt = (char*) pointer;
-  while(pagedir_get_page(thread_current()->pagedir,(void *)pt))
-  {
-    check_vaddr((const void*) pt);
-    if (*pt == '\0')
-      return;
-    pt++;
-  }
-  Err_exit(-1);
+  const uint8_t *start = buffer;
+  const uint8_t *end = start + size;
+  const uint8_t *upage;
+
+  if (size == 0)
+    return;
+  for (upage = pg_round_down (start); upage < end; upage += PGSIZE)
+    unpin_page (upage);
 }
 
 bool Sys_chdir (const char *dir)
@@ -473,7 +840,7 @@ bool Sys_isdir (int fd)
 int Sys_inumber (int fd)
 {
   struct file_node *node = get_file_node(fd);
-  if (!node)  return -1;
+  if (!node || node->pipe)  return -1;
 
   block_sector_t inumber;
   if (node->isdir)
@@ -492,14 +859,311 @@ int Sys_inumber (int fd)
 struct file_node * get_file_node(int fd)
 {
   struct thread *t = thread_current();
-  for (struct list_elem *e=list_begin(&t->file_list);e!=list_end(&t->file_list);
-       e = list_next(e)){
-    struct file_node *node = list_entry(e, struct file_node, elem);
-    if(node->fd==fd){
-      return node;
+  if (fd < 0 || fd >= t->fd_cnt)
+    return NULL;
+  return t->fd_table[fd];
+}
+
+/* Copies memory statistics for the calling process and the
+   whole system into MS. */
+bool Sys_memstat (struct memstat *ms)
+{
+  struct memstat tmp;
+  process_get_memstat (&tmp);
+  exception_get_stats (&tmp.sys.faults);
+  if (!copy_to_user (ms, &tmp, sizeof tmp))
+    Err_exit(-1);
+  return true;
+}
+
+/* Creates a pipe and stores the fds of its read end and its
+   write end in FDS[0] and FDS[1].  Returns true if successful,
+   false if memory is short. */
+bool Sys_pipe (int *fds)
+{
+  struct thread *t = thread_current();
+  struct file_node *ends[2];
+  struct pipe *p;
+  int i;
+
+  p = pipe_create();
+  if (p == NULL)
+    return false;
+  for (i = 0; i < 2; i++)
+    {
+      ends[i] = new_node();
+      if (ends[i] == NULL || fd_install(t, ends[i]) < 0)
+        {
+          slab_free(file_node_cache, ends[i]);
+          if (i > 0)
+            CloseFile(t, ends[0]->fd, false);
+          else
+            pipe_close(p, false);
+          pipe_close(p, true);
+          return false;
+        }
+      ends[i]->pipe = p;
+      ends[i]->pipe_write = i == 1;
+      fds[i] = ends[i]->fd;
     }
-  }
-  return NULL;
+  return true;
+}
+
+/* Gets (F_GETFL) or sets (F_SETFL) the status flags of FD, of
+   which there is only O_NONBLOCK.  Non-blocking reads and writes
+   return -1 instead of waiting, if they would wait: on the read
+   end of an empty pipe, the write end of a full pipe, or stdin
+   with no key waiting.  Files never wait, and writes to the
+   console never fail.
+
+   Also gets (F_GETFD) or sets (F_SETFD) the descriptor flags of
+   FD, of which there is only FD_CLOEXEC.  An fd with FD_CLOEXEC
+   is not passed on to children started by exec, though children
+   started by fork get it, flag and all.  The console fds are
+   always inherited.
+
+   Returns the flags for F_GETFL or F_GETFD, 0 for F_SETFL or
+   F_SETFD, or -1 if FD or CMD is bad. */
+int Sys_fcntl (int fd, int cmd, int arg)
+{
+  struct thread *t = thread_current();
+  struct file_node *node = get_file_node(fd);
+  bool *nonblock;
+
+  if (fd == STDIN_FILENO)
+    nonblock = &t->stdin_nonblock;
+  else if (node != NULL)
+    nonblock = &node->nonblock;
+  else if (fd == STDOUT_FILENO)
+    nonblock = NULL;
+  else
+    return -1;
+
+  switch (cmd)
+    {
+    case F_GETFL:
+      return nonblock != NULL && *nonblock ? O_NONBLOCK : 0;
+    case F_SETFL:
+      if (nonblock != NULL)
+        *nonblock = (arg & O_NONBLOCK) != 0;
+      return 0;
+    case F_GETFD:
+      return node != NULL && node->cloexec ? FD_CLOEXEC : 0;
+    case F_SETFD:
+      if (node != NULL)
+        node->cloexec = (arg & FD_CLOEXEC) != 0;
+      return 0;
+    default:
+      return -1;
+    }
+}
+
+/* Returns the poll events that hold for FD in the running
+   process, adding E to the wait queue of FD's object, if it has
+   one, so that SEMA is upped when that changes.  E may be null
+   to just check. */
+static int
+poll_fd (int fd, struct wait_entry *e, struct semaphore *sema)
+{
+  struct file_node *node;
+
+  if (fd == STDIN_FILENO)
+    return input_poll(e, sema) ? POLLIN : 0;
+  if (fd == STDOUT_FILENO)
+    return POLLOUT;
+  node = get_file_node(fd);
+  if (node == NULL)
+    return POLLNVAL;
+  if (node->pipe)
+    return pipe_poll(node->pipe, node->pipe_write, e, sema);
+  /* Files and directories never wait. */
+  return node->isdir ? POLLIN : POLLIN | POLLOUT;
+}
+
+/* Waits until at least one of the NFDS fds in user array FDS is
+   ready for the events it asks for, or for TIMEOUT milliseconds
+   if TIMEOUT is positive.  A TIMEOUT of 0 just checks, and a
+   negative TIMEOUT waits indefinitely.  The caller sleeps on the
+   wait queues of the fds' pipes and of the keyboard, and on a
+   timer alarm, rather than spinning.  Fills in each revents and
+   returns the number of fds with nonzero revents, which is 0 on
+   timeout, or -1 if NFDS is out of range or memory is short. */
+int Sys_poll (struct pollfd *ufds, int nfds, int timeout)
+{
+  struct pollfd *fds;
+  struct wait_entry *entries;
+  struct semaphore sema;
+  struct timer_alarm alarm;
+  int64_t deadline = 0;
+  bool expired = timeout == 0;
+  int ready, i;
+
+  if (nfds < 0 || nfds > POLL_MAX)
+    return -1;
+  fds = malloc(nfds * sizeof *fds);
+  entries = malloc(nfds * sizeof *entries);
+  if (nfds > 0 && (fds == NULL || entries == NULL))
+    {
+      free(fds);
+      free(entries);
+      return -1;
+    }
+  if (!copy_from_user(fds, ufds, nfds * sizeof *fds))
+    {
+      free(fds);
+      free(entries);
+      Err_exit(-1);
+    }
+  for (i = 0; i < nfds; i++)
+    entries[i].queue = NULL;
+
+  sema_init(&sema, 0);
+  if (timeout > 0)
+    {
+      int64_t ticks = DIV_ROUND_UP((int64_t) timeout * TIMER_FREQ, 1000);
+      deadline = timer_ticks() + ticks;
+      timer_alarm_set(&alarm, &sema, ticks);
+    }
+
+  for (;;)
+    {
+      /* Check every fd, and unless we are done waiting, get on
+         its wait queue first so that no change is missed between
+         the check and the sleep. */
+      ready = 0;
+      for (i = 0; i < nfds; i++)
+        {
+          int events = 0;
+
+          if (fds[i].fd >= 0)
+            events = poll_fd(fds[i].fd, expired ? NULL : &entries[i], &sema);
+          fds[i].revents = events & (fds[i].events
+                                     | POLLERR | POLLHUP | POLLNVAL);
+          if (fds[i].revents != 0)
+            ready++;
+        }
+      if (ready > 0 || expired)
+        break;
+
+      sema_down(&sema);
+      for (i = 0; i < nfds; i++)
+        wait_queue_remove(&entries[i]);
+      expired = timeout > 0 && timer_ticks() >= deadline;
+    }
+
+  for (i = 0; i < nfds; i++)
+    wait_queue_remove(&entries[i]);
+  if (timeout > 0)
+    timer_alarm_cancel(&alarm);
+  free(entries);
+  if (!copy_to_user(ufds, fds, nfds * sizeof *fds))
+    {
+      free(fds);
+      Err_exit(-1);
+    }
+  free(fds);
+  return ready;
 }
 
+/* Does the work of readv (if WRITE is false) and writev (if WRITE
+   is true) on FD, using the IOVCNT buffers described by the user
+   array UIOV in order.  A file is accessed at its current
+   position, which is advanced once at the end, and the transfer
+   stops at the first buffer that is not filled (or emptied)
+   completely.  Returns the number of bytes transferred, or -1 if
+   FD cannot be used or IOVCNT is out of range. */
+static int
+vectored_io (int fd, const struct iovec *uiov, int iovcnt, bool write)
+{
+  struct iovec iov[IOV_MAX];
+  struct file *file = NULL;
+  off_t pos = 0;
+  size_t sum = 0;
+  int total = 0;
+  int i;
+
+  if (iovcnt < 0 || iovcnt > IOV_MAX)
+    return -1;
+  if (!copy_from_user (iov, uiov, iovcnt * sizeof *iov))
+    Err_exit(-1);
+
+  // the byte count must fit in the int we return, so reject
+  // oversized lengths before doing any I/O
+  for (i = 0; i < iovcnt; i++)
+    {
+      if (iov[i].iov_len > INT_MAX - sum)
+        return -1;
+      sum += iov[i].iov_len;
+    }
+
+  struct file_node *node = get_file_node(fd);
+  if (fd == (write ? STDOUT_FILENO : STDIN_FILENO)
+      || (node != NULL && node->pipe != NULL))
+    file = NULL;
+  else
+    {
+      file = getFile(thread_current(), fd);
+      if (file == NULL)
+        return -1;
+      pos = file_tell(file);
+    }
 
+  for (i = 0; i < iovcnt; i++)
+    {
+      void *base = iov[i].iov_base;
+      int length = iov[i].iov_len;
+      int bytes;
+
+      if (!pin_buffer (base, length, !write))
+        Err_exit(-1);
+      if (file == NULL)
+        bytes = write ? Sys_write(fd, base, length) : Sys_read(fd, base, length);
+      else if (write)
+        bytes = file_write_at(file, base, length, pos + total);
+      else
+        bytes = file_read_at(file, base, length, pos + total);
+      unpin_buffer (base, length);
+
+      if (bytes < 0)
+        return total > 0 ? total : -1;
+      total += bytes;
+      if (bytes < length)
+        break;
+    }
+
+  if (file != NULL)
+    file_seek(file, pos + total);
+  return total;
+}
+
+// read from fd into several buffers, filling each before the next
+int Sys_readv(int fd, const struct iovec *iov, int iovcnt)
+{
+  return vectored_io(fd, iov, iovcnt, false);
+}
+
+// write to fd from several buffers, in order
+int Sys_writev(int fd, const struct iovec *iov, int iovcnt)
+{
+  return vectored_io(fd, iov, iovcnt, true);
+}
+
+// read from fd at position offset, without moving the file position
+// return -1 if fd is not an open file
+int Sys_pread(int fd, void *buffer, unsigned length, unsigned offset)
+{
+  struct file *f = getFile(thread_current(), fd);
+  if (!f || (off_t) offset < 0)
+    return -1;
+  return file_read_at(f, buffer, length, offset);
+}
+
+// write to fd at position offset, without moving the file position
+// return -1 if fd is not an open file
+int Sys_pwrite(int fd, const void *buffer, unsigned length, unsigned offset)
+{
+  struct file *f = getFile(thread_current(), fd);
+  if (!f || (off_t) offset < 0)
+    return -1;
+  return file_write_at(f, buffer, length, offset);
+}
@@ -2,6 +2,8 @@
 #define USERPROG_SYSCALL_H
 #include <stdbool.h>
 #include <debug.h>
+#include <iovec.h>
+#include <poll.h>
 #include "userprog/process.h"
 
 typedef int pid_t;
@@ -10,9 +12,12 @@ struct file_node
 {
   struct file *file;
   struct dir *dir;
+  struct pipe *pipe;   // non-NULL if this is one end of a pipe
   int fd;
   bool isdir;   // dir(T) or file(F) 
-  struct list_elem elem;
+  bool pipe_write;   // write end(T) or read end(F) of PIPE
+  bool nonblock;     // O_NONBLOCK: fail instead of waiting
+  bool cloexec;      // FD_CLOEXEC: not inherited by exec'd children
 };
 
 void syscall_init (void);
@@ -21,6 +26,7 @@ void syscall_init (void);
 void Sys_halt(void);
 void Sys_exit(int status);
 pid_t Sys_exec(const char *file);
+pid_t Sys_fork(void);
 int Sys_wait(pid_t pid);
 bool Sys_create(const char*file, unsigned initial_size);
 bool Sys_remove(const char*file);
@@ -40,5 +46,21 @@ bool Sys_readdir(int fd, char* name);
 bool Sys_isdir (int fd);
 int Sys_inumber (int fd);
 struct file_node * get_file_node(int fd);
+void CloseFile(struct thread *t, int fd, bool All);
+bool fd_table_copy(struct thread *dst, struct thread *src, bool exec);
+
+// memory statistics
+bool Sys_memstat (struct memstat *ms);
+
+// pipes and readiness
+bool Sys_pipe(int *fds);
+int Sys_fcntl(int fd, int cmd, int arg);
+int Sys_poll(struct pollfd *fds, int nfds, int timeout);
+
+// vectored and positional I/O
+int Sys_readv(int fd, const struct iovec *iov, int iovcnt);
+int Sys_writev(int fd, const struct iovec *iov, int iovcnt);
+int Sys_pread(int fd, void *buffer, unsigned length, unsigned offset);
+int Sys_pwrite(int fd, const void *buffer, unsigned length, unsigned offset);
 
 #endif /* userprog/syscall.h */
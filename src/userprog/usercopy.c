@@ -0,0 +1,95 @@
+#include "userprog/usercopy.h"
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+
+/* Copying to and from user memory.
+
+   These functions access user memory directly, without first
+   checking that it is mapped.  If it is not, the access faults,
+   and the page fault handler makes the function return failure
+   (see usercopy-asm.S), so a bad user pointer costs nothing until it
+   is actually used.  The only check made up front is that the
+   user range lies below PHYS_BASE, which takes no page table
+   walk. */
+
+/* Defined in usercopy-asm.S. */
+extern char usercopy_begin[], usercopy_end[];
+bool usercopy_memcpy (void *dst, const void *src, size_t size);
+int usercopy_strlcpy (char *dst, const char *usrc, size_t size);
+bool usercopy_get (uint8_t *dst, const uint8_t *usrc);
+bool usercopy_put (uint8_t *udst, uint8_t byte);
+
+/* Returns true if the SIZE bytes at UADDR are all user virtual
+   addresses. */
+static bool
+is_user_range (const void *uaddr, size_t size)
+{
+  uintptr_t start = (uintptr_t) uaddr;
+  return start + size >= start && start + size <= (uintptr_t) PHYS_BASE;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address
+   DST.  Returns true if successful, false if USRC is not valid
+   user memory. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size)
+{
+  return is_user_range (usrc, size) && usercopy_memcpy (dst, usrc, size);
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address
+   UDST.  Returns true if successful, false if UDST is not valid,
+   writable user memory. */
+bool
+copy_to_user (void *udst, const void *src, size_t size)
+{
+  return is_user_range (udst, size) && usercopy_memcpy (udst, src, size);
+}
+
+/* Copies the null-terminated string at user address USRC into
+   the SIZE-byte buffer DST.  Returns the length of the string,
+   not counting the null terminator, or -1 if USRC is not valid
+   user memory or the string does not fit in SIZE bytes. */
+int
+copy_string_from_user (char *dst, const char *usrc, size_t size)
+{
+  uintptr_t limit = (uintptr_t) PHYS_BASE - (uintptr_t) usrc;
+  int length;
+
+  if (!is_user_vaddr (usrc) || size == 0)
+    return -1;
+  if (size > limit)
+    size = limit;
+  length = usercopy_strlcpy (dst, usrc, size);
+  return (size_t) length < size ? length : -1;
+}
+
+/* Reads a byte at user address USRC into *DST.  Returns true if
+   successful, false if USRC is not valid user memory. */
+bool
+get_user (uint8_t *dst, const uint8_t *usrc)
+{
+  return is_user_vaddr (usrc) && usercopy_get (dst, usrc);
+}
+
+/* Writes BYTE to user address UDST.  Returns true if successful,
+   false if UDST is not valid, writable user memory. */
+bool
+put_user (uint8_t *udst, uint8_t byte)
+{
+  return is_user_vaddr (udst) && usercopy_put (udst, byte);
+}
+
+/* Called by the page fault handler for a fault in kernel mode
+   that could not be resolved.  If the faulting instruction is in
+   one of the copy routines, arranges for the routine to return
+   failure and returns true.  Otherwise returns false. */
+bool
+usercopy_fixup (struct intr_frame *f)
+{
+  if ((char *) f->eip < usercopy_begin || (char *) f->eip >= usercopy_end)
+    return false;
+  f->eip = (void (*) (void)) f->eax;
+  f->eax = 0;
+  return true;
+}
@@ -0,0 +1,343 @@
+#include "vm/frame.h"
+#include <debug.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+#include "vm/page.h"
+#include "vm/swap.h"
+
+/* Frame table.
+
+   Every page handed to a user process comes from the user pool
+   through frame_alloc(), which records it here.  When the user
+   pool runs dry, frames are reclaimed with the clock algorithm.
+   Eviction works in clusters: one sweep of the clock hand picks
+   up to SWAP_CLUSTER victims, and all of the victims that must
+   go to swap are written with one multi-sector transfer into
+   adjacent slots.  Victims are sorted by owner and address
+   first, so a process's neighboring pages end up in neighboring
+   slots, ready to be read back together.
+
+   A frame shared by several processes after fork is evicted as
+   a whole: it counts as accessed or dirty if any of its mappings
+   is, every mapping is cleared, and all of its pages share the
+   one swap slot it is written to.
+
+   A single lock serializes the frame table, eviction, and page
+   loading (see page.c).  It is held across swap I/O, which is
+   simple and safe: nothing that runs under it can fault on user
+   memory. */
+
+static struct list frame_list;          /* All frames, in clock order. */
+static struct list_elem *clock_hand;    /* Next frame the clock examines. */
+static size_t frame_cnt;                /* Number of frames in FRAME_LIST. */
+static struct lock frame_lock;          /* Protects all of the above. */
+
+static struct frame *evict (void);
+static size_t pick_victims (struct frame *victims[], size_t max);
+static void remove_frame (struct frame *);
+
+/* Initializes the frame table. */
+void
+frame_init (void)
+{
+  list_init (&frame_list);
+  lock_init (&frame_lock);
+  clock_hand = list_end (&frame_list);
+  frame_cnt = 0;
+}
+
+/* Acquires the lock that protects the frame table and every
+   process's resident pages. */
+void
+frame_table_lock (void)
+{
+  lock_acquire (&frame_lock);
+}
+
+/* Releases the lock acquired by frame_table_lock(). */
+void
+frame_table_unlock (void)
+{
+  lock_release (&frame_lock);
+}
+
+/* Obtains a frame from the user pool without evicting anything.
+   FLAGS is passed on to palloc_get_page() along with PAL_USER.
+   The new frame holds no pages and is pinned once; the caller
+   unpins it once a page is mapped to it.  Returns the frame, or
+   a null pointer if the user pool is empty.  The caller must
+   hold the frame table lock. */
+struct frame *
+frame_try_alloc (enum palloc_flags flags)
+{
+  void *kpage;
+
+  ASSERT (lock_held_by_current_thread (&frame_lock));
+
+  kpage = palloc_get_page (PAL_USER | flags);
+  if (kpage == NULL)
+    return NULL;
+  return frame_adopt (kpage);
+}
+
+/* Records KPAGE, a page already obtained from the user pool, as
+   a frame.  The frame is pinned, as with frame_try_alloc().
+   Returns the frame, or a null pointer if memory is short, in
+   which case KPAGE is freed.  The caller must hold the frame
+   table lock. */
+struct frame *
+frame_adopt (void *kpage)
+{
+  struct frame *f;
+
+  ASSERT (lock_held_by_current_thread (&frame_lock));
+
+  f = malloc (sizeof *f);
+  if (f == NULL)
+    {
+      palloc_free_page (kpage);
+      return NULL;
+    }
+  f->kpage = kpage;
+  list_init (&f->pages);
+  f->share_cnt = 0;
+  f->pin_cnt = 1;
+  list_push_back (&frame_list, &f->elem);
+  frame_cnt++;
+  return f;
+}
+
+/* Like frame_try_alloc(), but evicts other pages if the user
+   pool is empty.  Returns a null pointer only if nothing can be
+   evicted.  The caller must hold the frame table lock. */
+struct frame *
+frame_alloc (enum palloc_flags flags)
+{
+  struct frame *f;
+
+  ASSERT (lock_held_by_current_thread (&frame_lock));
+
+  f = frame_try_alloc (flags);
+  if (f != NULL)
+    return f;
+
+  /* The frame comes back still pinned once by pick_victims(),
+     which stands in for the pin that frame_try_alloc() takes. */
+  f = evict ();
+  if (f == NULL)
+    return NULL;
+
+  ASSERT (f->pin_cnt == 1);
+  ASSERT (list_empty (&f->pages));
+  if (flags & PAL_ZERO)
+    memset (f->kpage, 0, PGSIZE);
+  return f;
+}
+
+/* Removes F from the frame table and returns its page to the
+   user pool.  The caller must have unmapped and detached every
+   page from it already and must hold the frame table lock. */
+void
+frame_free (struct frame *f)
+{
+  ASSERT (lock_held_by_current_thread (&frame_lock));
+  ASSERT (list_empty (&f->pages));
+
+  remove_frame (f);
+  palloc_free_page (f->kpage);
+  free (f);
+}
+
+/* Returns the first page mapped to F, which must have one. */
+static struct page *
+first_page (struct frame *f)
+{
+  return list_entry (list_front (&f->pages), struct page, frame_elem);
+}
+
+/* Compares victims by the owner of their first page, then by its
+   user address. */
+static bool
+victim_less (struct frame *a_, struct frame *b_)
+{
+  struct page *a = first_page (a_);
+  struct page *b = first_page (b_);
+
+  if (a->owner != b->owner)
+    return a->owner < b->owner;
+  return a->upage < b->upage;
+}
+
+/* Evicts a cluster of pages and returns one of the freed frames,
+   still in the frame table, for the caller to reuse.  The others
+   go back to the user pool.  Returns a null pointer if every
+   frame is pinned. */
+static struct frame *
+evict (void)
+{
+  struct frame *victims[SWAP_CLUSTER];
+  void *kpages[SWAP_CLUSTER];
+  struct frame *dirty[SWAP_CLUSTER];
+  size_t victim_cnt, dirty_cnt;
+  size_t i, j;
+
+  victim_cnt = pick_victims (victims, SWAP_CLUSTER);
+  if (victim_cnt == 0)
+    return NULL;
+
+  /* Sort so that each process's pages are adjacent and in
+     address order.  There are only a few, so insertion sort. */
+  for (i = 1; i < victim_cnt; i++)
+    for (j = i; j > 0 && victim_less (victims[j], victims[j - 1]); j--)
+      {
+        struct frame *tmp = victims[j];
+        victims[j] = victims[j - 1];
+        victims[j - 1] = tmp;
+      }
+
+  /* Unmap every victim.  Pages whose contents exist nowhere else
+     must be written to swap; clean file and zero pages can
+     simply be dropped and reloaded later.  A process that has
+     exited and is waiting to be reaped will never touch its
+     pages again, so they are dropped even if dirty. */
+  dirty_cnt = 0;
+  for (i = 0; i < victim_cnt; i++)
+    {
+      struct frame *f = victims[i];
+      bool is_dirty = false;
+      struct list_elem *e;
+
+      for (e = list_begin (&f->pages); e != list_end (&f->pages);
+           e = list_next (e))
+        {
+          struct page *p = list_entry (e, struct page, frame_elem);
+          uint32_t *pd = p->owner->pagedir;
+
+          if (p->owner->status != THREAD_DYING
+              && (p->type == PAGE_SWAP || pagedir_is_dirty (pd, p->upage)))
+            is_dirty = true;
+          pagedir_clear_page (pd, p->upage);
+        }
+      if (is_dirty)
+        {
+          kpages[dirty_cnt] = f->kpage;
+          dirty[dirty_cnt++] = f;
+        }
+    }
+
+  /* Write the dirty pages in as few runs of adjacent slots as
+     the swap map allows. */
+  for (i = 0; i < dirty_cnt; )
+    {
+      size_t cnt = dirty_cnt - i;
+      size_t slot;
+
+      while ((slot = swap_alloc (cnt)) == SWAP_ERROR)
+        if (cnt == 1)
+          PANIC ("out of swap space");
+        else
+          cnt /= 2;
+
+      swap_write (slot, cnt, kpages + i);
+      for (j = 0; j < cnt; j++)
+        {
+          struct frame *f = dirty[i + j];
+          struct list_elem *e;
+
+          for (e = list_begin (&f->pages); e != list_end (&f->pages);
+               e = list_next (e))
+            {
+              struct page *p = list_entry (e, struct page, frame_elem);
+
+              if (e != list_begin (&f->pages))
+                swap_share (slot + j);
+              p->type = PAGE_SWAP;
+              p->swap_slot = slot + j;
+            }
+        }
+      i += cnt;
+    }
+
+  /* Detach the pages from their frames.  Keep the first frame
+     for the caller and release the rest. */
+  for (i = 0; i < victim_cnt; i++)
+    {
+      struct frame *f = victims[i];
+
+      while (!list_empty (&f->pages))
+        {
+          struct page *p = list_entry (list_pop_front (&f->pages),
+                                       struct page, frame_elem);
+          p->frame = NULL;
+          process_count_resident (p->owner, -1);
+        }
+      f->share_cnt = 0;
+      if (i > 0)
+        frame_free (f);
+    }
+  return victims[0];
+}
+
+/* Advances the clock hand over the frame table, selecting up to
+   MAX frames that are neither pinned nor recently accessed and
+   storing them in VICTIMS.  A shared frame counts as accessed if
+   any of its mappings is.  Accessed bits are cleared as the hand
+   passes, so two revolutions always suffice.  Returns the number
+   of frames selected; they are pinned so they are not selected
+   twice. */
+static size_t
+pick_victims (struct frame *victims[], size_t max)
+{
+  size_t victim_cnt = 0;
+  size_t steps;
+
+  for (steps = 0; steps < 2 * frame_cnt && victim_cnt < max; steps++)
+    {
+      struct frame *f;
+      struct list_elem *e;
+      bool accessed;
+
+      if (clock_hand == list_end (&frame_list))
+        clock_hand = list_begin (&frame_list);
+      f = list_entry (clock_hand, struct frame, elem);
+      clock_hand = list_next (clock_hand);
+
+      if (f->pin_cnt > 0)
+        continue;
+      accessed = false;
+      for (e = list_begin (&f->pages); e != list_end (&f->pages);
+           e = list_next (e))
+        {
+          struct page *p = list_entry (e, struct page, frame_elem);
+          uint32_t *pd = p->owner->pagedir;
+
+          if (pagedir_is_accessed (pd, p->upage))
+            {
+              pagedir_set_accessed (pd, p->upage, false);
+              accessed = true;
+            }
+        }
+      if (accessed)
+        continue;
+
+      f->pin_cnt++;
+      victims[victim_cnt++] = f;
+    }
+  return victim_cnt;
+}
+
+/* Removes F from the frame table, keeping the clock hand
+   valid. */
+static void
+remove_frame (struct frame *f)
+{
+  if (clock_hand == &f->elem)
+    clock_hand = list_next (clock_hand);
+  list_remove (&f->elem);
+  frame_cnt--;
+}
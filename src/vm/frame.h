@@ -0,0 +1,29 @@
+#ifndef VM_FRAME_H
+#define VM_FRAME_H
+
+#include <list.h>
+#include <stdbool.h>
+#include "threads/palloc.h"
+
+/* A physical frame from the user pool that holds a user page.
+   After fork, one frame may hold the same page for several
+   processes, each of which maps it read-only until it writes. */
+struct frame
+  {
+    void *kpage;                /* Kernel virtual address of the frame. */
+    struct list pages;          /* Pages mapped to this frame. */
+    unsigned share_cnt;         /* Pages in PAGES beyond the first. */
+    unsigned pin_cnt;           /* Never chosen for eviction if nonzero. */
+    struct list_elem elem;      /* Element in the frame table. */
+  };
+
+void frame_init (void);
+void frame_table_lock (void);
+void frame_table_unlock (void);
+
+struct frame *frame_alloc (enum palloc_flags);
+struct frame *frame_try_alloc (enum palloc_flags);
+struct frame *frame_adopt (void *kpage);
+void frame_free (struct frame *);
+
+#endif /* vm/frame.h */
@@ -0,0 +1,619 @@
+#include "vm/page.h"
+#include <debug.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+#include "vm/frame.h"
+#include "vm/swap.h"
+
+/* Supplemental page table.
+
+   Each process keeps a hash table of the user pages it may
+   touch, keyed by user virtual address.  A page is brought into
+   a frame on first access by page_load(), called from the page
+   fault handler, and may later be evicted by the frame table.
+
+   When a swapped-out page is faulted back in, up to
+   SWAP_READAROUND of the process's neighboring pages that sit in
+   adjacent swap slots are read with the same command.  Eviction
+   writes a process's pages to consecutive slots in address
+   order (see frame.c), so those neighbors are usually the pages
+   the process will touch next.
+
+   Pages that start out all zero (BSS, the stack, and the
+   all-zero tail of a segment) get no frame of their own until
+   they are written.  A read fault maps them read-only to a
+   single zero-filled page shared by every process; the first
+   write fault replaces that mapping with a private frame.
+   Large static arrays that are only partly used therefore cost
+   frames only for the parts that are written.
+
+   Fork shares the parent's modified and swapped-out pages with
+   the child instead of copying them.  A resident page's frame is
+   mapped read-only in both processes and counted in the frame's
+   share count; a swapped-out page's slot is shared the same way
+   in the swap map.  The first write fault on a shared frame gives
+   the writer a private copy (see unshare_page()), and a frame
+   whose other sharers have all gone is simply made writable
+   again. */
+
+/* Maximum number of extra pages read on each side of a faulting
+   swapped-out page. */
+#define SWAP_READAROUND ((SWAP_CLUSTER - 1) / 2)
+
+/* Zero-filled page mapped read-only into every process for
+   PAGE_ZERO pages that have only been read. */
+static void *zero_kpage;
+
+static hash_hash_func page_hash;
+static hash_less_func page_less;
+static hash_action_func destroy_page;
+
+static bool copy_page (const struct page *, struct thread *parent);
+static bool load_page (struct page *, bool write);
+static bool load_frame (struct page *, struct frame *);
+static bool load_swap (struct page *, struct frame *);
+static bool unshare_page (struct page *);
+static bool map_frame (struct page *, struct frame *);
+static void detach_page (struct page *);
+
+/* Initializes the paging code. */
+void
+page_init (void)
+{
+  zero_kpage = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+}
+
+/* Initializes supplemental page table PAGES for the running
+   process. */
+bool
+page_table_init (struct hash *pages)
+{
+  /* Every page fault looks up a page, so use open addressing,
+     which finds it without chasing list pointers. */
+  return hash_init_open (pages, page_hash, page_less, NULL);
+}
+
+/* Destroys process T's supplemental page table, releasing its
+   frames and swap slots.  T need not be the running thread; it
+   may be a process that has exited and is being reaped.  Must be
+   called before T's page directory is destroyed. */
+void
+page_table_destroy (struct thread *t)
+{
+  frame_table_lock ();
+  hash_destroy (&t->pages, destroy_page);
+  frame_table_unlock ();
+}
+
+/* Fills the running process's page table, which must be empty,
+   with copies of PARENT's pages, for a child process created by
+   fork.  Pages that the parent has modified, or that are in swap,
+   share the parent's frame or swap slot until one of the two
+   processes writes them; the others are left to be loaded on
+   demand, as in the parent.  File pages come from the running
+   process's own executable.  Returns true if successful. */
+bool
+page_table_copy (struct thread *parent)
+{
+  struct hash_iterator i;
+  bool success = true;
+
+  frame_table_lock ();
+  hash_first (&i, &parent->pages);
+  while (success && hash_next (&i))
+    success = copy_page (hash_entry (hash_cur (&i), struct page, hash_elem),
+                         parent);
+  frame_table_unlock ();
+  return success;
+}
+
+/* Returns the running process's page that contains ADDR, or a
+   null pointer if there is none. */
+struct page *
+page_lookup (const void *addr)
+{
+  struct page p;
+  struct hash_elem *e;
+
+  p.upage = pg_round_down (addr);
+  e = hash_find (&thread_current ()->pages, &p.hash_elem);
+  return e != NULL ? hash_entry (e, struct page, hash_elem) : NULL;
+}
+
+/* Adds a page at UPAGE to the running process's page table,
+   initialized with TYPE and WRITABLE.  Returns the page, or a
+   null pointer if UPAGE is already present or memory is
+   short. */
+static struct page *
+add_page (void *upage, enum page_type type, bool writable)
+{
+  struct page *p;
+
+  ASSERT (pg_ofs (upage) == 0);
+  ASSERT (is_user_vaddr (upage));
+
+  p = malloc (sizeof *p);
+  if (p == NULL)
+    return NULL;
+  p->upage = upage;
+  p->owner = thread_current ();
+  p->frame = NULL;
+  p->zero_mapped = false;
+  p->writable = writable;
+  p->type = type;
+  p->file = NULL;
+  p->ofs = 0;
+  p->read_bytes = 0;
+  p->swap_slot = PAGE_NO_SLOT;
+
+  if (hash_insert (&thread_current ()->pages, &p->hash_elem) != NULL)
+    {
+      free (p);
+      return NULL;
+    }
+  return p;
+}
+
+/* Adds a page at UPAGE to the running process whose first
+   READ_BYTES bytes come from FILE at offset OFS and whose
+   remaining bytes are zero.  Nothing is read until the page is
+   first accessed.  Returns true if successful. */
+bool
+page_add_file (void *upage, struct file *file, off_t ofs,
+               size_t read_bytes, bool writable)
+{
+  struct page *p;
+
+  ASSERT (read_bytes <= PGSIZE);
+
+  p = add_page (upage, PAGE_FILE, writable);
+  if (p == NULL)
+    return false;
+  p->file = file;
+  p->ofs = ofs;
+  p->read_bytes = read_bytes;
+  return true;
+}
+
+/* Adds an all-zero page at UPAGE to the running process.  No
+   frame is allocated until the page is first accessed.  Returns
+   true if successful. */
+bool
+page_add_zero (void *upage, bool writable)
+{
+  return add_page (upage, PAGE_ZERO, writable) != NULL;
+}
+
+/* Adds a page at UPAGE to the running process with a copy of
+   the page at kernel address KPAGE, and maps it right away.  The
+   copy goes in a new frame, for which other pages are evicted if
+   the user pool is full.  KPAGE is left to the caller.  Returns
+   true if successful. */
+bool
+page_add_copy (void *upage, const void *kpage, bool writable)
+{
+  struct page *p;
+  struct frame *f;
+  bool success = false;
+
+  frame_table_lock ();
+  p = add_page (upage, PAGE_ZERO, writable);
+  if (p != NULL && (f = frame_alloc (0)) != NULL)
+    {
+      memcpy (f->kpage, kpage, PGSIZE);
+
+      /* The contents now exist only in memory. */
+      p->type = PAGE_SWAP;
+      success = map_frame (p, f);
+      if (!success)
+        frame_free (f);
+    }
+  frame_table_unlock ();
+  return success;
+}
+
+/* Makes the running process's page that contains ADDR
+   accessible for reading, or for writing if WRITE is true, by
+   bringing it into a frame and mapping it.  An all-zero page is
+   mapped to the shared zero page if WRITE is false.  Returns
+   true if successful, false if ADDR is not part of the process's
+   address space, WRITE is true for a read-only page, or no frame
+   could be obtained. */
+bool
+page_load (const void *addr, bool write)
+{
+  bool success;
+
+  if (!is_user_vaddr (addr) || thread_current ()->pagedir == NULL)
+    return false;
+
+  frame_table_lock ();
+  success = load_page (page_lookup (addr), write);
+  frame_table_unlock ();
+  return success;
+}
+
+/* Like page_load(), but also pins the page's frame so that it
+   stays resident until a matching page_unpin() call.  The kernel
+   can then access the page, e.g. for device I/O, without
+   faulting.  Pins nest: a page pinned twice, e.g. because two
+   buffers share it, stays pinned until it is unpinned twice.
+
+   So that every pin is matched by exactly one unpin of the same
+   frame, a writable page is loaded as if for writing even when
+   it is only to be read.  That gives an all-zero page a frame of
+   its own and a page shared since fork a private copy, so it
+   cannot move to another frame while it is pinned.  A read-only
+   all-zero page is mapped to the shared zero page, which has no
+   frame but is never evicted either. */
+bool
+page_pin (const void *addr, bool write)
+{
+  struct page *p;
+  bool success;
+
+  if (!is_user_vaddr (addr) || thread_current ()->pagedir == NULL)
+    return false;
+
+  frame_table_lock ();
+  p = page_lookup (addr);
+  if (p != NULL && p->writable)
+    write = true;
+  success = load_page (p, write);
+  if (success && p->frame != NULL)
+    p->frame->pin_cnt++;
+  frame_table_unlock ();
+  return success;
+}
+
+/* Drops one pin of the running process's page that contains
+   ADDR, which must have been pinned with page_pin().  Does
+   nothing if ADDR is not in a page of the page table, such as a
+   large page. */
+void
+page_unpin (const void *addr)
+{
+  struct page *p;
+
+  frame_table_lock ();
+  p = page_lookup (addr);
+  if (p != NULL && p->frame != NULL)
+    {
+      ASSERT (p->frame->pin_cnt > 0);
+      p->frame->pin_cnt--;
+    }
+  frame_table_unlock ();
+}
+
+/* Adds a copy of page P, which belongs to PARENT, to the
+   running process.  The caller must hold the frame table lock. */
+static bool
+copy_page (const struct page *p, struct thread *parent)
+{
+  struct page *q;
+
+  q = add_page (p->upage, p->type, p->writable);
+  if (q == NULL)
+    return false;
+  if (p->type == PAGE_FILE)
+    {
+      q->file = thread_current ()->exec_file;
+      q->ofs = p->ofs;
+      q->read_bytes = p->read_bytes;
+    }
+
+  if (p->frame != NULL
+      && (p->type != PAGE_FILE
+          || pagedir_is_dirty (parent->pagedir, p->upage)))
+    {
+      /* The contents exist only in the parent's frame.  Map it
+         read-only in both processes, so that whichever writes
+         first takes a copy. */
+      struct frame *f = p->frame;
+
+      if (!pagedir_set_page (thread_current ()->pagedir, q->upage,
+                             f->kpage, false))
+        return false;
+      pagedir_set_writable (parent->pagedir, p->upage, false);
+      q->type = PAGE_SWAP;
+      q->frame = f;
+      list_push_back (&f->pages, &q->frame_elem);
+      f->share_cnt++;
+      process_count_resident (thread_current (), 1);
+    }
+  else if (p->swap_slot != PAGE_NO_SLOT)
+    {
+      /* The contents exist only in the parent's swap slot.  Each
+         process reads it into a frame of its own when it next
+         touches the page. */
+      swap_share (p->swap_slot);
+      q->swap_slot = p->swap_slot;
+    }
+  return true;
+}
+
+/* Does the work of page_load() for page P, which may be null.
+   The caller must hold the frame table lock. */
+static bool
+load_page (struct page *p, bool write)
+{
+  uint32_t *pd = thread_current ()->pagedir;
+  struct frame *f;
+
+  if (p == NULL || (write && !p->writable))
+    return false;
+  if (p->frame != NULL)
+    {
+      /* Already resident, e.g. brought in by read-around, but
+         mapped read-only if shared since fork. */
+      if (write && !pagedir_is_writable (pd, p->upage))
+        return unshare_page (p);
+      return true;
+    }
+  if (p->zero_mapped)
+    {
+      if (!write)
+        return true;
+
+      /* First write: trade the shared page for a private one. */
+      pagedir_clear_page (pd, p->upage);
+      p->zero_mapped = false;
+    }
+  else if (!write && p->type == PAGE_ZERO)
+    {
+      p->zero_mapped = pagedir_set_page (pd, p->upage, zero_kpage, false);
+      return p->zero_mapped;
+    }
+
+  f = frame_alloc (0);
+  if (f == NULL)
+    return false;
+  if (!load_frame (p, f))
+    {
+      frame_free (f);
+      return false;
+    }
+  return true;
+}
+
+/* Fills frame F with the contents of page P and maps it.
+   Returns true if successful. */
+static bool
+load_frame (struct page *p, struct frame *f)
+{
+  switch (p->type)
+    {
+    case PAGE_FILE:
+      if (file_read_at (p->file, f->kpage, p->read_bytes, p->ofs)
+          != (off_t) p->read_bytes)
+        return false;
+      memset ((uint8_t *) f->kpage + p->read_bytes, 0,
+              PGSIZE - p->read_bytes);
+      process_count_segment_page ();
+      return map_frame (p, f);
+
+    case PAGE_ZERO:
+      memset (f->kpage, 0, PGSIZE);
+      return map_frame (p, f);
+
+    case PAGE_SWAP:
+      if (p->swap_slot == PAGE_NO_SLOT)
+        {
+          /* Never written out, so never modified. */
+          memset (f->kpage, 0, PGSIZE);
+          return map_frame (p, f);
+        }
+      return load_swap (p, f);
+    }
+  NOT_REACHED ();
+}
+
+/* Returns true if Q, the page DELTA pages away from P, is a
+   swapped-out page whose slot is DELTA slots away from P's. */
+static bool
+is_swap_neighbor (const struct page *p, const struct page *q, int delta)
+{
+  return (q != NULL && q->frame == NULL && q->type == PAGE_SWAP
+          && q->swap_slot != PAGE_NO_SLOT
+          && q->swap_slot == p->swap_slot + delta);
+}
+
+/* Reads swapped-out page P into frame F, along with as many of
+   its neighbors as sit in adjacent slots and can get a frame
+   without eviction, then maps all of them.  Returns true if
+   successful. */
+static bool
+load_swap (struct page *p, struct frame *f)
+{
+  struct page *pages[2 * SWAP_READAROUND + 1];
+  struct frame *frames[2 * SWAP_READAROUND + 1];
+  void *kpages[2 * SWAP_READAROUND + 1];
+  int before, after, delta;
+  size_t first_slot;
+  int i, cnt;
+
+  /* Gather neighbors below and above P, stopping at the first
+     page that is not in the next slot or cannot get a frame. */
+  before = 0;
+  for (delta = -1; delta >= -SWAP_READAROUND; delta--)
+    {
+      struct page *q;
+      struct frame *qf;
+
+      q = page_lookup ((uint8_t *) p->upage + delta * PGSIZE);
+      if (!is_swap_neighbor (p, q, delta))
+        break;
+      qf = frame_try_alloc (0);
+      if (qf == NULL)
+        break;
+      pages[SWAP_READAROUND + delta] = q;
+      frames[SWAP_READAROUND + delta] = qf;
+      before++;
+    }
+  pages[SWAP_READAROUND] = p;
+  frames[SWAP_READAROUND] = f;
+  after = 0;
+  for (delta = 1; delta <= SWAP_READAROUND; delta++)
+    {
+      struct page *q;
+      struct frame *qf;
+
+      q = page_lookup ((uint8_t *) p->upage + delta * PGSIZE);
+      if (!is_swap_neighbor (p, q, delta))
+        break;
+      qf = frame_try_alloc (0);
+      if (qf == NULL)
+        break;
+      pages[SWAP_READAROUND + delta] = q;
+      frames[SWAP_READAROUND + delta] = qf;
+      after++;
+    }
+
+  /* Read the whole run with one command. */
+  first_slot = p->swap_slot - before;
+  cnt = before + 1 + after;
+  for (i = 0; i < cnt; i++)
+    kpages[i] = frames[SWAP_READAROUND - before + i]->kpage;
+  swap_read (first_slot, cnt, kpages);
+
+  /* Map the neighbors.  Their accessed bits start out clear, so
+     they are the first to go if the process never touches them.
+     A page's slot is released only once it is mapped, so if
+     mapping fails the page simply stays in swap. */
+  for (i = 0; i < cnt; i++)
+    {
+      struct page *q = pages[SWAP_READAROUND - before + i];
+      struct frame *qf = frames[SWAP_READAROUND - before + i];
+
+      if (q == p)
+        continue;
+      if (map_frame (q, qf))
+        {
+          swap_free (q->swap_slot);
+          q->swap_slot = PAGE_NO_SLOT;
+        }
+      else
+        frame_free (qf);
+    }
+
+  if (!map_frame (p, f))
+    return false;
+  swap_free (p->swap_slot);
+  p->swap_slot = PAGE_NO_SLOT;
+  return true;
+}
+
+/* Gives writable page P, which is resident but mapped read-only
+   because its frame was shared at fork, a frame to write to.  If
+   P still shares its frame, P gets a private copy of it;
+   otherwise the other sharers are gone and P's mapping is simply
+   made writable.  Returns true if successful. */
+static bool
+unshare_page (struct page *p)
+{
+  struct frame *old = p->frame;
+  struct frame *f;
+
+  if (old->share_cnt == 0)
+    {
+      pagedir_set_writable (p->owner->pagedir, p->upage, true);
+      return true;
+    }
+
+  /* Pin the shared frame so that getting a frame for the copy
+     cannot evict it. */
+  old->pin_cnt++;
+  f = frame_alloc (0);
+  old->pin_cnt--;
+  if (f == NULL)
+    return false;
+  memcpy (f->kpage, old->kpage, PGSIZE);
+  detach_page (p);
+
+  /* The copy now exists only in memory.  Its page table entry
+     was just cleared, not freed, so mapping it cannot fail. */
+  p->type = PAGE_SWAP;
+  if (!map_frame (p, f))
+    NOT_REACHED ();
+  return true;
+}
+
+/* Maps page P to frame F, which must not hold any other page, in
+   the running process's page directory and drops the pin that F
+   was allocated with.  Returns true if successful. */
+static bool
+map_frame (struct page *p, struct frame *f)
+{
+  ASSERT (list_empty (&f->pages));
+
+  if (!pagedir_set_page (thread_current ()->pagedir, p->upage, f->kpage,
+                         p->writable))
+    return false;
+  p->frame = f;
+  list_push_back (&f->pages, &p->frame_elem);
+  f->pin_cnt--;
+  process_count_resident (thread_current (), 1);
+  return true;
+}
+
+/* Unmaps page P from its owner's page directory and removes it
+   from its frame, which may still hold other pages. */
+static void
+detach_page (struct page *p)
+{
+  struct frame *f = p->frame;
+
+  pagedir_clear_page (p->owner->pagedir, p->upage);
+  list_remove (&p->frame_elem);
+  if (!list_empty (&f->pages))
+    f->share_cnt--;
+  p->frame = NULL;
+  process_count_resident (p->owner, -1);
+}
+
+/* Returns a hash value for the page that E refers to. */
+static unsigned
+page_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct page *p = hash_entry (e, struct page, hash_elem);
+  return hash_bytes (&p->upage, sizeof p->upage);
+}
+
+/* Returns true if page A precedes page B. */
+static bool
+page_less (const struct hash_elem *a_, const struct hash_elem *b_,
+           void *aux UNUSED)
+{
+  const struct page *a = hash_entry (a_, struct page, hash_elem);
+  const struct page *b = hash_entry (b_, struct page, hash_elem);
+  return a->upage < b->upage;
+}
+
+/* Releases the frame or swap slot held by the page that E
+   refers to, then frees the page.  A frame that other processes
+   still share is left to them. */
+static void
+destroy_page (struct hash_elem *e, void *aux UNUSED)
+{
+  struct page *p = hash_entry (e, struct page, hash_elem);
+
+  if (p->frame != NULL)
+    {
+      struct frame *f = p->frame;
+
+      detach_page (p);
+      if (list_empty (&f->pages))
+        frame_free (f);
+    }
+  else if (p->zero_mapped)
+    pagedir_clear_page (p->owner->pagedir, p->upage);
+  if (p->swap_slot != PAGE_NO_SLOT)
+    swap_free (p->swap_slot);
+  free (p);
+}
@@ -0,0 +1,61 @@
+#ifndef VM_PAGE_H
+#define VM_PAGE_H
+
+#include <hash.h>
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct file;
+struct frame;
+struct thread;
+
+/* Where a page's contents come from while it is not resident. */
+enum page_type
+  {
+    PAGE_FILE,                  /* READ_BYTES from FILE, then zeros. */
+    PAGE_ZERO,                  /* All zeros. */
+    PAGE_SWAP                   /* Anonymous: a swap slot, if any. */
+  };
+
+/* Swap slot value for a page that does not occupy one. */
+#define PAGE_NO_SLOT ((size_t) -1)
+
+/* A virtual page in a process's supplemental page table. */
+struct page
+  {
+    void *upage;                /* User virtual address. */
+    struct thread *owner;       /* Process whose page table holds this. */
+    struct frame *frame;        /* Backing frame, or null if not resident. */
+    struct list_elem frame_elem; /* Element in FRAME's list of pages. */
+    bool zero_mapped;           /* Mapped read-only to the shared zero page. */
+    bool writable;              /* Read/write if true, read-only if false. */
+    enum page_type type;        /* Backing store when not resident. */
+
+    /* PAGE_FILE. */
+    struct file *file;          /* File to read from. */
+    off_t ofs;                  /* Offset in FILE. */
+    size_t read_bytes;          /* Bytes to read; the rest is zeroed. */
+
+    /* PAGE_SWAP. */
+    size_t swap_slot;           /* Swap slot, or PAGE_NO_SLOT. */
+
+    struct hash_elem hash_elem; /* Element in the thread's page table. */
+  };
+
+void page_init (void);
+bool page_table_init (struct hash *);
+void page_table_destroy (struct thread *);
+bool page_table_copy (struct thread *parent);
+
+struct page *page_lookup (const void *addr);
+bool page_add_file (void *upage, struct file *, off_t ofs,
+                    size_t read_bytes, bool writable);
+bool page_add_zero (void *upage, bool writable);
+bool page_add_copy (void *upage, const void *kpage, bool writable);
+bool page_load (const void *addr, bool write);
+bool page_pin (const void *addr, bool write);
+void page_unpin (const void *addr);
+
+#endif /* vm/page.h */
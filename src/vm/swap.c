@@ -0,0 +1,178 @@
+#include "vm/swap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "devices/block.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Swap space.
+
+   The swap device is divided into page-sized slots, tracked by
+   a bitmap.  Slots are handed out next-fit: each allocation
+   starts searching where the previous one ended, so pages that
+   are evicted one after another land in adjacent slots.  That
+   keeps a process's evicted pages clustered on disk, which lets
+   the fault handler bring back its neighbors with the same
+   command (see page.c).
+
+   After fork, the parent's and the child's copies of a page may
+   share one slot.  A slot's share count holds the number of
+   pages that use it beyond the first, and the slot is released
+   only when the last of them lets go of it.
+
+   Transfers go through block_read_multiple() and
+   block_write_multiple(), so a run of CNT slots is moved with a
+   single device command instead of one command per sector. */
+
+/* Number of sectors in a page. */
+#define SECTORS_PER_PAGE (PGSIZE / BLOCK_SECTOR_SIZE)
+
+static struct block *swap_device;   /* Swap block device. */
+static struct bitmap *used_map;     /* Slots in use. */
+static uint16_t *share_cnt;         /* Extra users, by slot. */
+static size_t next_slot;            /* Where the next search starts. */
+static struct lock swap_lock;       /* Protects all of the above. */
+
+/* Per-sector buffer pointers for one transfer.
+   Static because it is too big for a kernel stack; protected by
+   swap_lock. */
+static void *sector_bufs[SWAP_CLUSTER * SECTORS_PER_PAGE];
+
+/* Statistics. */
+static long long write_cmds;        /* # of write commands issued. */
+static long long pages_written;     /* # of pages written. */
+static long long read_cmds;         /* # of read commands issued. */
+static long long pages_read;        /* # of pages read. */
+
+static void transfer (size_t slot, size_t cnt, void *kpages[], bool write);
+
+/* Initializes the swap space.  If no swap device has been
+   assigned, every allocation fails. */
+void
+swap_init (void)
+{
+  lock_init (&swap_lock);
+  next_slot = 0;
+  swap_device = block_get_role (BLOCK_SWAP);
+  if (swap_device == NULL)
+    return;
+
+  used_map = bitmap_create (block_size (swap_device) / SECTORS_PER_PAGE);
+  share_cnt = calloc (bitmap_size (used_map), sizeof *share_cnt);
+  if (used_map == NULL || share_cnt == NULL)
+    PANIC ("swap: bitmap creation failed");
+}
+
+/* Allocates CNT adjacent swap slots and returns the index of the
+   first one, or SWAP_ERROR if there is no free run that long. */
+size_t
+swap_alloc (size_t cnt)
+{
+  size_t slot;
+
+  ASSERT (cnt > 0 && cnt <= SWAP_CLUSTER);
+
+  if (used_map == NULL)
+    return SWAP_ERROR;
+
+  lock_acquire (&swap_lock);
+  slot = bitmap_scan_and_flip (used_map, next_slot, cnt, false);
+  if (slot == BITMAP_ERROR && next_slot != 0)
+    slot = bitmap_scan_and_flip (used_map, 0, cnt, false);
+  if (slot != BITMAP_ERROR)
+    next_slot = slot + cnt;
+  else
+    slot = SWAP_ERROR;
+  lock_release (&swap_lock);
+
+  return slot;
+}
+
+/* Adds a user to swap slot SLOT, which must be allocated.  The
+   slot is then released only after one more swap_free() call. */
+void
+swap_share (size_t slot)
+{
+  lock_acquire (&swap_lock);
+  ASSERT (bitmap_test (used_map, slot));
+  share_cnt[slot]++;
+  lock_release (&swap_lock);
+}
+
+/* Drops one user of swap slot SLOT, releasing it if it was the
+   last. */
+void
+swap_free (size_t slot)
+{
+  lock_acquire (&swap_lock);
+  ASSERT (bitmap_test (used_map, slot));
+  if (share_cnt[slot] > 0)
+    share_cnt[slot]--;
+  else
+    bitmap_reset (used_map, slot);
+  lock_release (&swap_lock);
+}
+
+/* Writes the CNT pages in KPAGES to the CNT slots starting at
+   SLOT, which must have been obtained from swap_alloc(). */
+void
+swap_write (size_t slot, size_t cnt, void *kpages[])
+{
+  transfer (slot, cnt, kpages, true);
+}
+
+/* Reads the CNT slots starting at SLOT into the CNT pages in
+   KPAGES.  The slots remain allocated. */
+void
+swap_read (size_t slot, size_t cnt, void *kpages[])
+{
+  transfer (slot, cnt, kpages, false);
+}
+
+/* Prints swap statistics. */
+void
+swap_print_stats (void)
+{
+  if (swap_device == NULL)
+    return;
+  printf ("Swap: %lld pages written in %lld commands, "
+          "%lld pages read in %lld commands\n",
+          pages_written, write_cmds, pages_read, read_cmds);
+}
+
+/* Moves CNT pages between KPAGES and the slots starting at SLOT
+   with a single multi-sector block transfer. */
+static void
+transfer (size_t slot, size_t cnt, void *kpages[], bool write)
+{
+  size_t i, j;
+
+  ASSERT (cnt > 0 && cnt <= SWAP_CLUSTER);
+  ASSERT (swap_device != NULL);
+
+  lock_acquire (&swap_lock);
+  ASSERT (bitmap_all (used_map, slot, cnt));
+  for (i = 0; i < cnt; i++)
+    for (j = 0; j < SECTORS_PER_PAGE; j++)
+      sector_bufs[i * SECTORS_PER_PAGE + j]
+        = (uint8_t *) kpages[i] + j * BLOCK_SECTOR_SIZE;
+
+  if (write)
+    {
+      block_write_multiple (swap_device, slot * SECTORS_PER_PAGE,
+                            cnt * SECTORS_PER_PAGE, sector_bufs);
+      write_cmds++;
+      pages_written += cnt;
+    }
+  else
+    {
+      block_read_multiple (swap_device, slot * SECTORS_PER_PAGE,
+                           cnt * SECTORS_PER_PAGE, sector_bufs);
+      read_cmds++;
+      pages_read += cnt;
+    }
+  lock_release (&swap_lock);
+}
@@ -0,0 +1,21 @@
+#ifndef VM_SWAP_H
+#define VM_SWAP_H
+
+#include <stddef.h>
+
+/* Swap slot index.  Each slot holds exactly one page. */
+#define SWAP_ERROR SIZE_MAX
+
+/* Maximum number of pages moved by one swap_write() or
+   swap_read() call. */
+#define SWAP_CLUSTER 16
+
+void swap_init (void);
+size_t swap_alloc (size_t cnt);
+void swap_share (size_t slot);
+void swap_free (size_t slot);
+void swap_write (size_t slot, size_t cnt, void *kpages[]);
+void swap_read (size_t slot, size_t cnt, void *kpages[]);
+void swap_print_stats (void);
+
+#endif /* vm/swap.h */